@@ -10,30 +10,677 @@
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
-
+#include <string.h>
 
 #include "./utils/benchmark.h"
 
+#define BENCHMARK_DATASET_COUNT 3
+
+static const char *benchmark_dataset_paths[BENCHMARK_DATASET_COUNT] = {
+    "./benchmark/data/canada.json",
+    "./benchmark/data/citm_catalog.json",
+    "./benchmark/data/twitter.json",
+};
+
+static const char *benchmark_dataset_names[BENCHMARK_DATASET_COUNT] = {
+    "canada.json",
+    "citm_catalog.json",
+    "twitter.json",
+};
+
+/**
+ * Feeds the file to an incremental parser, in chunks of the given size.
+ */
+jsn_handle benchmark_parse_chunked(const char *file_path, size_t chunk_size) {
+    FILE *file_ptr = fopen(file_path, "r");
+    char *chunk = malloc(chunk_size);
+    size_t count;
+
+    struct jsn_parser *parser = jsn_parser_new();
+    while ((count = fread(chunk, 1, chunk_size, file_ptr)) > 0) {
+        jsn_parser_feed(parser, chunk, count);
+    }
+
+    free(chunk);
+    fclose(file_ptr);
+
+    return jsn_parser_finish(parser);
+}
+
+/**
+ * Reads the whole file into memory.
+ */
+char *benchmark_read_file(const char *file_path, size_t *length) {
+    FILE *file_ptr = fopen(file_path, "r");
+    fseek(file_ptr, 0, SEEK_END);
+    *length = ftell(file_ptr);
+    fseek(file_ptr, 0, SEEK_SET);
+
+    char *buffer = malloc(*length);
+    *length = fread(buffer, 1, *length, file_ptr);
+    fclose(file_ptr);
+
+    return buffer;
+}
+
+/**
+ * Returns the size of the given file in bytes.
+ */
+unsigned long benchmark_file_size(const char *file_path) {
+    FILE *file_ptr = fopen(file_path, "r");
+    fseek(file_ptr, 0, SEEK_END);
+    unsigned long size = ftell(file_ptr);
+    fclose(file_ptr);
+
+    return size;
+}
+
+/**
+ * Event callback that counts the values it's called for.
+ */
+void benchmark_count_value(void *count) { (*(unsigned long *)count)++; }
+void benchmark_count_span(void *count, const char *span, size_t length) {
+    (*(unsigned long *)count)++;
+}
+void benchmark_count_integer(void *count, int value) {
+    (*(unsigned long *)count)++;
+}
+void benchmark_count_double(void *count, double value) {
+    (*(unsigned long *)count)++;
+}
+void benchmark_count_boolean(void *count, bool value) {
+    (*(unsigned long *)count)++;
+}
+
+static const struct jsn_handler benchmark_counter = {
+    benchmark_count_value,   benchmark_count_value,
+    benchmark_count_value,   benchmark_count_value,
+    benchmark_count_span,    benchmark_count_span,
+    benchmark_count_integer, benchmark_count_double,
+    benchmark_count_boolean, benchmark_count_value};
+
+/**
+ * Generates newline delimited log records, of about the given size.
+ */
+char *benchmark_generate_ndjson(size_t size, size_t *length) {
+    char *buffer = malloc(size + 256);
+    const char *levels[] = {"debug", "info", "warning", "error"};
+    *length = 0;
+
+    for (unsigned int i = 0; *length < size; i++) {
+        *length += sprintf(&buffer[*length],
+                           "{\"id\": %u, \"level\": \"%s\", "
+                           "\"latency\": %u.%02u, "
+                           "\"message\": \"request %u handled\", "
+                           "\"tags\": [\"api\", \"v2\"], \"cached\": %s}\n",
+                           i, levels[i % 4], i % 500, i % 100, i,
+                           i % 3 == 0 ? "true" : "false");
+    }
+
+    return buffer;
+}
+
+void benchmark_free_record(void *user_data, jsn_handle record) {
+    jsn_free(record);
+}
+
+/* DATASET PHASES:
+ * -------------------------------------------------------------------------*/
+
+/**
+ * A dataset, and what it's phases produced during the current run. The free
+ * phase releases everything the other phases allocated.
+ */
+struct benchmark_dataset {
+    const char *path;
+    char *buffer;
+    size_t length;
+    unsigned long events;
+    jsn_handle tree;
+    char *output;
+};
+
+void benchmark_phase_read(void *argument) {
+    struct benchmark_dataset *dataset = argument;
+    dataset->buffer = benchmark_read_file(dataset->path, &dataset->length);
+}
+
+void benchmark_phase_tokenize(void *argument) {
+    struct benchmark_dataset *dataset = argument;
+    jsn_events_from_buffer(dataset->buffer, dataset->length, &benchmark_counter,
+                           &dataset->events);
+}
+
+void benchmark_phase_build(void *argument) {
+    struct benchmark_dataset *dataset = argument;
+    dataset->tree = jsn_from_buffer(dataset->buffer, dataset->length);
+}
+
+void benchmark_phase_serialize(void *argument) {
+    struct benchmark_dataset *dataset = argument;
+    dataset->output = jsn_to_buffer(dataset->tree, NULL);
+}
+
+void benchmark_phase_free(void *argument) {
+    struct benchmark_dataset *dataset = argument;
+    jsn_free(dataset->tree);
+    free(dataset->output);
+    free(dataset->buffer);
+}
+
+static const struct jsn_benchmark_phase benchmark_dataset_phases[] = {
+    {"read", benchmark_phase_read},
+    {"tokenize", benchmark_phase_tokenize},
+    {"build", benchmark_phase_build},
+    {"serialize", benchmark_phase_serialize},
+    {"free", benchmark_phase_free},
+};
+
+/* BENCHMARKS:
+ * -------------------------------------------------------------------------*/
+
+void benchmark_parse_file(void *file_path) {
+    jsn_free(jsn_from_file(file_path));
+}
+
+void benchmark_parse_tape(void *file_path) {
+    jsn_tape_free(jsn_tape_from_file(file_path));
+}
+
+/**
+ * Prints the allocator calls of running the function once.
+ */
+void benchmark_print_allocations(const char *name,
+                                 jsn_benchmark_function function,
+                                 void *argument) {
+    struct jsn_allocation_stats stats = {0};
+    jsn_count_allocations(&stats);
+    function(argument);
+    jsn_count_allocations(NULL);
+
+    printf("%-52s %zu allocations, %zu reallocations, %zu frees, %zu bytes\n",
+           name, stats.allocations, stats.reallocations, stats.frees,
+           stats.bytes);
+}
+
+void benchmark_parse_file_chunked(void *file_path) {
+    jsn_free(benchmark_parse_chunked(file_path, 4096));
+}
+
+void benchmark_build_array(void *argument) {
+    jsn_handle array = jsn_create_array();
+    for (int i = 0; i < 1000000; i++) {
+        jsn_array_push(array, jsn_create_integer(i));
+    }
+    jsn_free(array);
+}
+
+void benchmark_set_object_keys(void *argument) {
+    jsn_handle object = jsn_create_object();
+    char key[32];
+
+    for (int i = 0; i < 100000; i++) {
+        sprintf(key, "key_%d", i);
+        jsn_object_set(object, key, jsn_create_integer(i));
+    }
+    jsn_free(object);
+}
+
+void benchmark_get_object_keys(void *object) {
+    char key[32];
+
+    for (int i = 0; i < 100000; i++) {
+        sprintf(key, "key_%d", i);
+        jsn_get(object, 1, key);
+    }
+}
+
+/**
+ * Twitter's source, it's parsed tree and what's read from them.
+ */
+struct benchmark_twitter {
+    char *buffer;
+    size_t length;
+    jsn_handle tree;
+    jsn_handle statuses;
+    struct jsn_tape *tape;
+    struct jsn_tape_value tape_statuses;
+    struct jsn_path *followers;
+    struct jsn_path *paths[12];
+    jsn_handle values[12];
+    long sum;
+};
+
+void benchmark_tree_reading(void *argument) {
+    struct benchmark_twitter *twitter = argument;
+    jsn_handle tree = jsn_from_buffer(twitter->buffer, twitter->length);
+
+    twitter->sum +=
+        jsn_get_value_int(jsn_get(tree, 2, "search_metadata", "count"));
+    twitter->sum += jsn_get_value_int(
+        jsn_get(jsn_get_array_item(jsn_get(tree, 1, "statuses"), 50), 2,
+                "user", "followers_count"));
+    jsn_free(tree);
+}
+
+void benchmark_tape_reading(void *argument) {
+    struct benchmark_twitter *twitter = argument;
+    struct jsn_tape *tape =
+        jsn_tape_from_buffer(twitter->buffer, twitter->length);
+    struct jsn_tape_value root = jsn_tape_root(tape);
+
+    twitter->sum += jsn_tape_get_value_int(
+        jsn_tape_get(root, 2, "search_metadata", "count"));
+    twitter->sum += jsn_tape_get_value_int(
+        jsn_tape_get(jsn_tape_get_array_item(jsn_tape_get(root, 1, "statuses"),
+                                             50),
+                     2, "user", "followers_count"));
+    jsn_tape_free(tape);
+}
+
+void benchmark_cursor_reading(void *argument) {
+    struct benchmark_twitter *twitter = argument;
+    struct jsn_cursor cursor =
+        jsn_cursor_from_buffer(twitter->buffer, twitter->length);
+
+    twitter->sum += jsn_cursor_get_value_int(
+        jsn_cursor_get(cursor, 2, "search_metadata", "count"));
+    twitter->sum += jsn_cursor_get_value_int(jsn_cursor_get(
+        jsn_cursor_get_array_item(jsn_cursor_get(cursor, 1, "statuses"), 50),
+        2, "user", "followers_count"));
+}
+
+void benchmark_nested_get(void *argument) {
+    struct benchmark_twitter *twitter = argument;
+    unsigned int count = jsn_array_count(twitter->statuses);
+
+    for (int i = 0; i < 1000; i++) {
+        for (unsigned int j = 0; j < count; j++) {
+            jsn_handle status = jsn_get_array_item(twitter->statuses, j);
+            twitter->sum += jsn_get_value_int(
+                jsn_get(status, 2, "user", "followers_count"));
+        }
+    }
+}
+
+void benchmark_nested_tape(void *argument) {
+    struct benchmark_twitter *twitter = argument;
+    unsigned int count = jsn_tape_array_count(twitter->tape_statuses);
+
+    for (int i = 0; i < 1000; i++) {
+        for (unsigned int j = 0; j < count; j++) {
+            struct jsn_tape_value status =
+                jsn_tape_get_array_item(twitter->tape_statuses, j);
+            twitter->sum += jsn_tape_get_value_int(
+                jsn_tape_get(status, 2, "user", "followers_count"));
+        }
+    }
+}
+
+void benchmark_nested_path(void *argument) {
+    struct benchmark_twitter *twitter = argument;
+    unsigned int count = jsn_array_count(twitter->statuses);
+
+    for (int i = 0; i < 1000; i++) {
+        for (unsigned int j = 0; j < count; j++) {
+            jsn_handle status = jsn_get_array_item(twitter->statuses, j);
+            twitter->sum += jsn_get_value_int(
+                jsn_path_eval(twitter->followers, status));
+        }
+    }
+}
+
+void benchmark_extract_fields(void *argument) {
+    struct benchmark_twitter *twitter = argument;
+    jsn_handle tree = jsn_from_buffer(twitter->buffer, twitter->length);
+
+    for (int i = 0; i < 12; i++) {
+        twitter->values[i] = jsn_path_eval(twitter->paths[i], tree);
+    }
+    jsn_free(tree);
+}
+
+void benchmark_project_fields(void *argument) {
+    struct benchmark_twitter *twitter = argument;
+    jsn_free(jsn_project(twitter->paths, 12, twitter->buffer, twitter->length,
+                         twitter->values));
+}
+
+void benchmark_write_file(void *tree) {
+    jsn_to_file(tree, "./bin/twitter.json");
+}
+
+void benchmark_write_buffer(void *tree) { free(jsn_to_buffer(tree, NULL)); }
+
+/**
+ * A document, as JSON and in the binary encoding.
+ */
+struct benchmark_encoded {
+    char *json;
+    size_t json_length;
+    char *binary;
+    size_t binary_length;
+};
+
+void benchmark_parse_json(void *argument) {
+    struct benchmark_encoded *encoded = argument;
+    jsn_free(jsn_from_buffer(encoded->json, encoded->json_length));
+}
+
+void benchmark_decode_binary(void *argument) {
+    struct benchmark_encoded *encoded = argument;
+    jsn_free(jsn_from_binary(encoded->binary, encoded->binary_length));
+}
+
+void benchmark_parse_and_read(void *sum) {
+    jsn_handle tree = jsn_from_file("./benchmark/data/twitter.json");
+    *(long *)sum +=
+        jsn_get_value_int(jsn_get(tree, 2, "search_metadata", "count"));
+    jsn_free(tree);
+}
+
+void benchmark_open_snapshot_and_read(void *sum) {
+    struct jsn_snapshot *snapshot = jsn_snapshot_open("./bin/twitter.snapshot");
+    *(long *)sum += jsn_frozen_get_value_int(jsn_frozen_get(
+        jsn_snapshot_root(snapshot), 2, "search_metadata", "count"));
+    jsn_snapshot_close(snapshot);
+}
+
+/**
+ * A newline delimited corpus, parsed with the given number of threads.
+ */
+struct benchmark_ndjson {
+    char *buffer;
+    size_t length;
+    unsigned int threads;
+};
+
+void benchmark_parse_ndjson(void *argument) {
+    struct benchmark_ndjson *ndjson = argument;
+    jsn_ndjson_for_each(ndjson->buffer, ndjson->length, ndjson->threads,
+                        benchmark_free_record, NULL);
+}
+
+void benchmark_usage() {
+    printf("Usage: benchmark-runner [--runs N] [--warmup N] [--output FILE]\n"
+           "       benchmark-runner [--threshold PERCENT] --compare BASELINE "
+           "CURRENT\n");
+}
+
 int main(int argc, char *argv[]) {
-    // Canada benchmark.
-    jsn_benchmark_start();
-    jsn_handle canada = jsn_from_file("./benchmark/data/canada.json");
-    jsn_benchmark_end("Parsing of ./benchmark/data/canada.json      ");
+    const char *output_path = "./bin/benchmark-results.json";
+    const char *baseline_path = NULL;
+    const char *current_path = NULL;
+    unsigned int warmup_runs = 2;
+    unsigned int runs = 10;
+    double threshold = 5;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            warmup_runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 2 < argc) {
+            baseline_path = argv[++i];
+            current_path = argv[++i];
+        } else {
+            benchmark_usage();
+            return 1;
+        }
+    }
+
+    // Compare mode, fails when anything got slower.
+    if (baseline_path != NULL) {
+        unsigned int slower =
+            jsn_benchmark_compare(baseline_path, current_path, threshold);
+        return slower == 0 ? 0 : 1;
+    }
+
+    jsn_benchmark_configure(warmup_runs, runs);
 
-    // Citm Catalog benchmark.
-    jsn_benchmark_start();
-    jsn_handle citm = jsn_from_file("./benchmark/data/citm_catalog.json");
-    jsn_benchmark_end("Parsing of ./benchmark/data/citm_catalog.json");
+    // Each dataset's pipeline, phase by phase, in the main parsing modes.
+    const char *mode_names[] = {"default", "indexed", "arena"};
+    const enum jsn_option mode_options[] = {0, JSN_OPTION_STRUCTURAL_INDEX,
+                                            JSN_OPTION_ARENA};
+    char name[256];
 
-    // Twitter benchmark.
-    jsn_benchmark_start();
-    jsn_handle twitter = jsn_from_file("./benchmark/data/twitter.json");
-    jsn_benchmark_end("Parsing of ./benchmark/data/twitter.json     ");
+    for (int mode = 0; mode < 3; mode++) {
+        if (mode_options[mode] != 0) {
+            jsn_set_option(mode_options[mode], true);
+        }
 
-    // free.
+        for (int i = 0; i < BENCHMARK_DATASET_COUNT; i++) {
+            struct benchmark_dataset dataset = {0};
+            dataset.path = benchmark_dataset_paths[i];
+            snprintf(name, sizeof(name), "%s/%s", mode_names[mode],
+                     benchmark_dataset_names[i]);
+            jsn_benchmark_run_phases(
+                name, benchmark_file_size(dataset.path),
+                benchmark_dataset_phases,
+                sizeof(benchmark_dataset_phases) /
+                    sizeof(benchmark_dataset_phases[0]),
+                &dataset);
+            benchmark_print_allocations(name, benchmark_parse_file,
+                                        (void *)dataset.path);
+        }
+
+        if (mode_options[mode] != 0) {
+            jsn_set_option(mode_options[mode], false);
+        }
+    }
+
+    // Parsing files, including reading them, in-situ and in 4KB chunks.
+    for (int i = 0; i < BENCHMARK_DATASET_COUNT; i++) {
+        const char *path = benchmark_dataset_paths[i];
+        unsigned long bytes = benchmark_file_size(path);
+
+        snprintf(name, sizeof(name), "file/%s", benchmark_dataset_names[i]);
+        jsn_benchmark_run(name, bytes, benchmark_parse_file, (void *)path);
+
+        jsn_set_option(JSN_OPTION_INSITU, true);
+        snprintf(name, sizeof(name), "in-situ/%s", benchmark_dataset_names[i]);
+        jsn_benchmark_run(name, bytes, benchmark_parse_file, (void *)path);
+        jsn_set_option(JSN_OPTION_INSITU, false);
+
+        snprintf(name, sizeof(name), "chunked/%s", benchmark_dataset_names[i]);
+        jsn_benchmark_run(name, bytes, benchmark_parse_file_chunked,
+                          (void *)path);
+
+        snprintf(name, sizeof(name), "tape/%s", benchmark_dataset_names[i]);
+        jsn_benchmark_run(name, bytes, benchmark_parse_tape, (void *)path);
+        benchmark_print_allocations(name, benchmark_parse_tape, (void *)path);
+    }
+
+    // Building a large array, appending should stay linear.
+    jsn_benchmark_run("build/array of 1000000 integers", 0,
+                      benchmark_build_array, NULL);
+
+    // String heavy document, parsed with the SIMD and the scalar string
+    // scanners.
+    char long_string[4097];
+    memset(long_string, 'x', 4096);
+    long_string[4096] = '\0';
+    long_string[2048] = '\\';
+    long_string[2049] = '"';
+
+    jsn_handle strings = jsn_create_array();
+    for (int i = 0; i < 4096; i++) {
+        jsn_array_push(strings, jsn_create_string(long_string));
+    }
+    jsn_to_file(strings, "./bin/strings.json");
+    jsn_free(strings);
+
+    unsigned long strings_bytes = benchmark_file_size("./bin/strings.json");
+    jsn_benchmark_run("strings/simd", strings_bytes, benchmark_parse_file,
+                      (void *)"./bin/strings.json");
+    jsn_set_option(JSN_OPTION_SCALAR, true);
+    jsn_benchmark_run("strings/scalar", strings_bytes, benchmark_parse_file,
+                      (void *)"./bin/strings.json");
+    jsn_set_option(JSN_OPTION_SCALAR, false);
+
+    // Large object benchmarks, keys are looked up through a hash index.
+    jsn_benchmark_run("object/set 100000 keys", 0, benchmark_set_object_keys,
+                      NULL);
+
+    jsn_handle large_object = jsn_create_object();
+    for (int i = 0; i < 100000; i++) {
+        sprintf(name, "key_%d", i);
+        jsn_object_set(large_object, name, jsn_create_integer(i));
+    }
+    jsn_benchmark_run("object/get 100000 keys", 0, benchmark_get_object_keys,
+                      large_object);
+    jsn_free(large_object);
+
+    // Reading a few fields of twitter.json, with the tree, an on-demand
+    // cursor, compiled paths and a projection.
+    const char *expressions[] = {
+        "search_metadata.count",
+        "search_metadata.max_id",
+        "search_metadata.query",
+        "statuses[0].id",
+        "statuses[0].text",
+        "statuses[0].user.screen_name",
+        "statuses[0].user.followers_count",
+        "statuses[10].retweet_count",
+        "statuses[50].user.lang",
+        "statuses[50].created_at",
+        "statuses[99].id_str",
+        "statuses[99].user.name",
+    };
+
+    struct benchmark_twitter twitter;
+    twitter.buffer =
+        benchmark_read_file("./benchmark/data/twitter.json", &twitter.length);
+    twitter.tree = jsn_from_buffer(twitter.buffer, twitter.length);
+    twitter.statuses = jsn_get(twitter.tree, 1, "statuses");
+    twitter.tape = jsn_tape_from_buffer(twitter.buffer, twitter.length);
+    twitter.tape_statuses =
+        jsn_tape_get(jsn_tape_root(twitter.tape), 1, "statuses");
+    twitter.followers = jsn_path_compile("user.followers_count");
+    twitter.sum = 0;
+    for (int i = 0; i < 12; i++) {
+        twitter.paths[i] = jsn_path_compile(expressions[i]);
+    }
+
+    jsn_benchmark_run("reading/2 fields with the tree", twitter.length,
+                      benchmark_tree_reading, &twitter);
+    jsn_benchmark_run("reading/2 fields with a cursor", twitter.length,
+                      benchmark_cursor_reading, &twitter);
+    jsn_benchmark_run("reading/2 fields with a tape", twitter.length,
+                      benchmark_tape_reading, &twitter);
+    jsn_benchmark_run("reading/100000 nested fields with jsn_get", 0,
+                      benchmark_nested_get, &twitter);
+    jsn_benchmark_run("reading/100000 nested fields with a path", 0,
+                      benchmark_nested_path, &twitter);
+    jsn_benchmark_run("reading/100000 nested fields with a tape", 0,
+                      benchmark_nested_tape, &twitter);
+    jsn_benchmark_run("reading/12 fields with the tree", twitter.length,
+                      benchmark_extract_fields, &twitter);
+    jsn_benchmark_run("reading/12 fields with a projection", twitter.length,
+                      benchmark_project_fields, &twitter);
+
+    // Serialization benchmarks.
+    jsn_benchmark_run("writing/twitter.json to a file", 0,
+                      benchmark_write_file, twitter.tree);
+    jsn_benchmark_run("writing/twitter.json to a buffer", 0,
+                      benchmark_write_buffer, twitter.tree);
+
+    jsn_free(twitter.tree);
+    jsn_tape_free(twitter.tape);
+    jsn_path_free(twitter.followers);
+    for (int i = 0; i < 12; i++) {
+        jsn_path_free(twitter.paths[i]);
+    }
+    free(twitter.buffer);
+
+    // Number heavy serialization, which also has to survive a round trip.
+    jsn_handle canada = jsn_from_file("./benchmark/data/canada.json");
+    jsn_benchmark_run("writing/canada.json to a buffer", 0,
+                      benchmark_write_buffer, canada);
+
+    size_t canada_length;
+    char *canada_json = jsn_to_buffer(canada, &canada_length);
+    jsn_free(canada);
+
+    canada = jsn_from_buffer(canada_json, canada_length);
+    size_t round_trip_length;
+    char *round_trip_json = jsn_to_buffer(canada, &round_trip_length);
     jsn_free(canada);
-    jsn_free(citm);
-    jsn_free(twitter);
+
+    bool round_trip_passed =
+        canada_length == round_trip_length &&
+        memcmp(canada_json, round_trip_json, canada_length) == 0;
+    printf("Round trip of canada.json: %s\n",
+           round_trip_passed ? "passed" : "FAILED");
+
+    free(round_trip_json);
+    free(canada_json);
+
+    // Binary encoding benchmarks, against parsing the same content as JSON.
+    for (int i = 0; i < BENCHMARK_DATASET_COUNT; i++) {
+        const char *path = benchmark_dataset_paths[i];
+        struct benchmark_encoded encoded;
+        encoded.json = benchmark_read_file(path, &encoded.json_length);
+
+        jsn_handle document =
+            jsn_from_buffer(encoded.json, encoded.json_length);
+        encoded.binary = jsn_to_binary(document, &encoded.binary_length);
+        jsn_free(document);
+
+        printf("Binary encoding of %s: %zu bytes, JSON: %zu bytes\n",
+               benchmark_dataset_names[i], encoded.binary_length,
+               encoded.json_length);
+
+        snprintf(name, sizeof(name), "binary/%s json",
+                 benchmark_dataset_names[i]);
+        jsn_benchmark_run(name, encoded.json_length, benchmark_parse_json,
+                          &encoded);
+        snprintf(name, sizeof(name), "binary/%s binary",
+                 benchmark_dataset_names[i]);
+        jsn_benchmark_run(name, encoded.binary_length, benchmark_decode_binary,
+                          &encoded);
+
+        free(encoded.binary);
+        free(encoded.json);
+    }
+
+    // Frozen snapshot benchmarks, startup and a lookup against parsing.
+    jsn_handle twitter_tree = jsn_from_file("./benchmark/data/twitter.json");
+    jsn_to_snapshot(twitter_tree, "./bin/twitter.snapshot");
+    jsn_free(twitter_tree);
+
+    long sum = 0;
+    jsn_benchmark_run("snapshot/parse and read a value", 0,
+                      benchmark_parse_and_read, &sum);
+    jsn_benchmark_run("snapshot/open and read a value", 0,
+                      benchmark_open_snapshot_and_read, &sum);
+
+    // NDJSON scaling, from one thread up to sixteen.
+    struct benchmark_ndjson ndjson;
+    ndjson.buffer = benchmark_generate_ndjson(16 << 20, &ndjson.length);
+    double single_thread_seconds = 0;
+
+    for (ndjson.threads = 1; ndjson.threads <= 16; ndjson.threads *= 2) {
+        snprintf(name, sizeof(name), "ndjson/%u threads", ndjson.threads);
+        double seconds = jsn_benchmark_run(name, ndjson.length,
+                                           benchmark_parse_ndjson, &ndjson);
+
+        if (ndjson.threads == 1) {
+            single_thread_seconds = seconds;
+        }
+
+        printf("NDJSON speedup on %2u threads: %5.2fx\n", ndjson.threads,
+               single_thread_seconds / seconds);
+    }
+
+    free(ndjson.buffer);
+
+    jsn_benchmark_write_results(output_path);
+    printf("Results written to %s\n", output_path);
 
     return 0;
 }
@@ -7,41 +7,276 @@
  **/
 
 #include "benchmark.h"
+#include "../../jsn.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
-static clock_t benchmark_clock;
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCHMARK_CYCLES
+#endif
 
-void jsn_benchmark_start() {
-    benchmark_clock = clock();
-    printf("Benchmarking:\n");
+/**
+ * The statistics of a benchmark's measured runs.
+ */
+struct jsn_benchmark_result {
+    char *name;
+    unsigned long bytes;
+    double min;
+    double median;
+    double p95;
+    // Time stamp counter ticks of the median run, zero when unavailable.
+    double median_cycles;
+};
+
+static unsigned int benchmark_warmup_runs = 2;
+static unsigned int benchmark_runs = 10;
+
+static struct jsn_benchmark_result *benchmark_results = NULL;
+static unsigned int benchmark_result_count = 0;
+static unsigned int benchmark_result_capacity = 0;
+
+/**
+ * Returns the monotonic wall clock time in seconds.
+ */
+static double benchmark_seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static double benchmark_cycles() {
+#ifdef BENCHMARK_CYCLES
+    return (double)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static int benchmark_compare_samples(const void *a, const void *b) {
+    double difference = *(const double *)a - *(const double *)b;
+    return (difference > 0) - (difference < 0);
+}
+
+/**
+ * Returns the nearest rank percentile of the given sorted samples.
+ */
+static double benchmark_percentile(const double *samples, unsigned int count,
+                                   unsigned int percentile) {
+    unsigned int rank = (count * percentile + 99) / 100;
+    return samples[rank == 0 ? 0 : rank - 1];
+}
+
+/**
+ * Records the statistics of the given samples, which are sorted in place.
+ * Returns the median.
+ */
+static double benchmark_record(const char *name, unsigned long bytes,
+                               double *seconds, double *cycles) {
+    if (benchmark_result_count == benchmark_result_capacity) {
+        benchmark_result_capacity =
+            benchmark_result_capacity == 0 ? 64 : benchmark_result_capacity * 2;
+        benchmark_results =
+            realloc(benchmark_results, sizeof(struct jsn_benchmark_result) *
+                                           benchmark_result_capacity);
+    }
+
+    qsort(seconds, benchmark_runs, sizeof(double), benchmark_compare_samples);
+    qsort(cycles, benchmark_runs, sizeof(double), benchmark_compare_samples);
+
+    struct jsn_benchmark_result *result =
+        &benchmark_results[benchmark_result_count++];
+    result->name = strdup(name);
+    result->bytes = bytes;
+    result->min = seconds[0];
+    result->median = benchmark_percentile(seconds, benchmark_runs, 50);
+    result->p95 = benchmark_percentile(seconds, benchmark_runs, 95);
+    result->median_cycles = benchmark_percentile(cycles, benchmark_runs, 50);
+
+    printf("%-52s median %9.3f ms, p95 %9.3f ms, min %9.3f ms", name,
+           result->median * 1000, result->p95 * 1000, result->min * 1000);
+
+    if (bytes != 0) {
+        printf(", %8.2f MB/s", bytes / result->median / (1024 * 1024));
+    }
+
+    if (bytes != 0 && result->median_cycles != 0) {
+        printf(", %.3f bytes/cycle", bytes / result->median_cycles);
+    }
+
+    printf("\n");
+
+    return result->median;
 }
 
-void jsn_benchmark_end(const char *log_prefix) {
-    double delta = (double)(clock() - benchmark_clock);
-    double elapsed_time = delta / CLOCKS_PER_SEC;
+void jsn_benchmark_configure(unsigned int warmup_runs, unsigned int runs) {
+    benchmark_warmup_runs = warmup_runs;
+    benchmark_runs = runs == 0 ? 1 : runs;
+}
 
-    // Print out benchmark results.
-    printf("Benchmark Result:\n");
-    printf("---------------------------------------------------------------\n");
-    printf("It took %f, seconds!\n", elapsed_time);
-    printf("---------------------------------------------------------------\n");
+double jsn_benchmark_run(const char *name, unsigned long bytes,
+                         jsn_benchmark_function function, void *argument) {
+    double *seconds = malloc(sizeof(double) * benchmark_runs);
+    double *cycles = malloc(sizeof(double) * benchmark_runs);
 
-    // Write the result to a file.
-    FILE *f = fopen("./benchmark/results.txt", "a");
+    for (unsigned int i = 0; i < benchmark_warmup_runs; i++) {
+        function(argument);
+    }
 
-    if (f == NULL) {
-        printf("Error opening file!\n");
-        exit(1);
+    for (unsigned int i = 0; i < benchmark_runs; i++) {
+        double start_cycles = benchmark_cycles();
+        double start = benchmark_seconds();
+        function(argument);
+        seconds[i] = benchmark_seconds() - start;
+        cycles[i] = benchmark_cycles() - start_cycles;
     }
 
-    // get the time.
-    time_t t = time(NULL);
-    struct tm tm = *localtime(&t);
-    fprintf(f, "%d-%02d-%02d %02d:%02d:%02d | ", tm.tm_year + 1900,
-            tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
-    fprintf(f, "%s | %f seconds.\n", log_prefix, elapsed_time);
-    fclose(f);
+    double median = benchmark_record(name, bytes, seconds, cycles);
+
+    free(seconds);
+    free(cycles);
+
+    return median;
 }
 
+void jsn_benchmark_run_phases(const char *name, unsigned long bytes,
+                              const struct jsn_benchmark_phase *phases,
+                              unsigned int phase_count, void *argument) {
+    double *seconds = malloc(sizeof(double) * benchmark_runs * phase_count);
+    double *cycles = malloc(sizeof(double) * benchmark_runs * phase_count);
+
+    for (unsigned int i = 0; i < benchmark_warmup_runs + benchmark_runs; i++) {
+        for (unsigned int j = 0; j < phase_count; j++) {
+            double start_cycles = benchmark_cycles();
+            double start = benchmark_seconds();
+            phases[j].function(argument);
+            double elapsed = benchmark_seconds() - start;
+            double elapsed_cycles = benchmark_cycles() - start_cycles;
+
+            // Each phase's samples are stored together.
+            if (i >= benchmark_warmup_runs) {
+                unsigned int sample =
+                    j * benchmark_runs + (i - benchmark_warmup_runs);
+                seconds[sample] = elapsed;
+                cycles[sample] = elapsed_cycles;
+            }
+        }
+    }
+
+    for (unsigned int j = 0; j < phase_count; j++) {
+        char phase_name[256];
+        snprintf(phase_name, sizeof(phase_name), "%s/%s", name, phases[j].name);
+        benchmark_record(phase_name, bytes, &seconds[j * benchmark_runs],
+                         &cycles[j * benchmark_runs]);
+    }
+
+    free(seconds);
+    free(cycles);
+}
+
+void jsn_benchmark_write_results(const char *file_path) {
+    jsn_handle root = jsn_create_object();
+    jsn_object_set(root, "warmup_runs",
+                   jsn_create_integer(benchmark_warmup_runs));
+    jsn_object_set(root, "runs", jsn_create_integer(benchmark_runs));
+    jsn_handle benchmarks =
+        jsn_object_set(root, "benchmarks", jsn_create_array());
+
+    for (unsigned int i = 0; i < benchmark_result_count; i++) {
+        struct jsn_benchmark_result *result = &benchmark_results[i];
+        double megabytes = result->bytes / (1024.0 * 1024.0);
+
+        jsn_handle entry = jsn_array_push(benchmarks, jsn_create_object());
+        jsn_object_set(entry, "name", jsn_create_string(result->name));
+        jsn_object_set(entry, "bytes", jsn_create_integer(result->bytes));
+        jsn_object_set(entry, "min_seconds", jsn_create_double(result->min));
+        jsn_object_set(entry, "median_seconds",
+                       jsn_create_double(result->median));
+        jsn_object_set(entry, "p95_seconds", jsn_create_double(result->p95));
+        jsn_object_set(entry, "mb_per_second",
+                       jsn_create_double(megabytes / result->median));
+        jsn_object_set(entry, "median_cycles",
+                       jsn_create_double(result->median_cycles));
+
+        free(result->name);
+    }
+
+    jsn_to_file(root, file_path);
+    jsn_free(root);
+
+    free(benchmark_results);
+    benchmark_results = NULL;
+    benchmark_result_count = 0;
+    benchmark_result_capacity = 0;
+}
+
+/**
+ * Returns the entry of the named benchmark, or NULL if there is none.
+ */
+static jsn_handle benchmark_find(jsn_handle benchmarks, const char *name) {
+    unsigned int count = jsn_array_count(benchmarks);
+
+    for (unsigned int i = 0; i < count; i++) {
+        jsn_handle entry = jsn_get_array_item(benchmarks, i);
+        if (strcmp(jsn_get_value_string(jsn_get(entry, 1, "name")), name) ==
+            0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static double benchmark_value(jsn_handle entry, const char *key) {
+    return jsn_get_value_double(jsn_get(entry, 1, key));
+}
+
+unsigned int jsn_benchmark_compare(const char *baseline_path,
+                                   const char *current_path,
+                                   double threshold) {
+    jsn_handle baseline = jsn_from_file(baseline_path);
+    jsn_handle current = jsn_from_file(current_path);
+    jsn_handle baseline_benchmarks = jsn_get(baseline, 1, "benchmarks");
+    jsn_handle current_benchmarks = jsn_get(current, 1, "benchmarks");
+
+    unsigned int count = jsn_array_count(current_benchmarks);
+    unsigned int slower = 0;
+
+    for (unsigned int i = 0; i < count; i++) {
+        jsn_handle after = jsn_get_array_item(current_benchmarks, i);
+        const char *name = jsn_get_value_string(jsn_get(after, 1, "name"));
+        jsn_handle before = benchmark_find(baseline_benchmarks, name);
+
+        if (before == NULL) {
+            printf("%-52s %9.3f ms (new)\n", name,
+                   benchmark_value(after, "median_seconds") * 1000);
+            continue;
+        }
+
+        double before_median = benchmark_value(before, "median_seconds");
+        double after_median = benchmark_value(after, "median_seconds");
+        double change = (after_median - before_median) / before_median * 100;
+
+        // A change within the noise of the runs isn't reported.
+        const char *verdict = "";
+        if (change > threshold && benchmark_value(after, "min_seconds") >
+                                      benchmark_value(before, "p95_seconds")) {
+            verdict = " slower";
+            slower++;
+        } else if (change < -threshold &&
+                   benchmark_value(after, "p95_seconds") <
+                       benchmark_value(before, "min_seconds")) {
+            verdict = " faster";
+        }
+
+        printf("%-52s %9.3f ms -> %9.3f ms %+7.1f%%%s\n", name,
+               before_median * 1000, after_median * 1000, change, verdict);
+    }
+
+    jsn_free(baseline);
+    jsn_free(current);
+
+    return slower;
+}
@@ -9,8 +9,54 @@
  * Created: 2022-10-21
  **/
 
-void jsn_benchmark_start();
+/**
+ * The measured work, it's called once per run with the benchmark's argument.
+ */
+typedef void (*jsn_benchmark_function)(void *argument);
+
+/**
+ * One step of a pipeline, that's timed separately from the other steps.
+ */
+struct jsn_benchmark_phase {
+    const char *name;
+    jsn_benchmark_function function;
+};
+
+/**
+ * Sets the number of unmeasured warm-up runs and of measured runs, used by
+ * the benchmarks that follow.
+ */
+void jsn_benchmark_configure(unsigned int warmup_runs, unsigned int runs);
+
+/**
+ * Runs the function the configured number of times, and records it's timings
+ * under the given name. The throughput is reported for the given number of
+ * processed bytes, unless it's zero. Returns the median run time in seconds.
+ */
+double jsn_benchmark_run(const char *name, unsigned long bytes,
+                         jsn_benchmark_function function, void *argument);
+
+/**
+ * Runs the phases one after the other, the configured number of times. Each
+ * phase is recorded as "name/phase", with the same argument and throughput.
+ */
+void jsn_benchmark_run_phases(const char *name, unsigned long bytes,
+                              const struct jsn_benchmark_phase *phases,
+                              unsigned int phase_count, void *argument);
 
-void jsn_benchmark_end(const char *log_prefix);
+/**
+ * Writes the recorded results to the given file as JSON, and releases them.
+ */
+void jsn_benchmark_write_results(const char *file_path);
+
+/**
+ * Prints the change of each benchmark's median between two result files.
+ * Changes are only reported as real when they exceed the threshold (in
+ * percent) and the runs of both files don't overlap. Returns the number of
+ * benchmarks that got slower.
+ */
+unsigned int jsn_benchmark_compare(const char *baseline_path,
+                                   const char *current_path,
+                                   double threshold);
 
 #endif
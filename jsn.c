@@ -9,11 +9,42 @@
 #include "jsn.h"
 #include <assert.h>
 #include <ctype.h>
+#include <limits.h>
+#include <math.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// SIMD kernels are available on x86 when compiling with GCC or Clang, they can
+// be disabled by defining JSN_NO_SIMD.
+#if !defined(JSN_NO_SIMD) && defined(__GNUC__) && defined(__SSE2__) &&        \
+    (defined(__x86_64__) || defined(__i386__))
+#define JSN_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// Files are memory mapped on POSIX systems, they can be read into the heap
+// instead by defining JSN_NO_MMAP.
+#if !defined(JSN_NO_MMAP) && (defined(__unix__) || defined(__APPLE__))
+#define JSN_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Newline delimited JSON is parsed on multiple threads on POSIX systems, it's
+// parsed on the calling thread instead by defining JSN_NO_THREADS.
+#if !defined(JSN_NO_THREADS) && (defined(__unix__) || defined(__APPLE__))
+#define JSN_THREADS
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#endif
+
 /* UTILITIES
  * --------------------------------------------------------------------------*/
 
@@ -22,6 +53,407 @@ void jsn_report_failure(const char *message) {
     exit(EXIT_FAILURE);
 }
 
+// The currently enabled options (see enum jsn_option).
+static unsigned int jsn_options = 0;
+
+// The threads JSN_OPTION_PARALLEL parses on, zero uses one per online CPU.
+static unsigned int jsn_parallel_threads = 0;
+
+#ifdef JSN_SIMD_X86
+/**
+ * Returns true if the CPU supports AVX2, SSE2 is always available.
+ */
+bool jsn_cpu_has_avx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+}
+#endif
+
+/* ALLOCATOR:
+ * --------------------------------------------------------------------------*/
+
+void *jsn_default_malloc(void *user_data, size_t size) {
+    (void)user_data;
+    return malloc(size);
+}
+
+void *jsn_default_realloc(void *user_data, void *memory, size_t size) {
+    (void)user_data;
+    return realloc(memory, size);
+}
+
+void jsn_default_free(void *user_data, void *memory) {
+    (void)user_data;
+    free(memory);
+}
+
+// The allocator used for all memory that stays owned by the library.
+static struct jsn_allocator jsn_allocator = {
+    jsn_default_malloc, jsn_default_realloc, jsn_default_free, NULL};
+
+// The statistics being counted into, or NULL when not counting.
+static struct jsn_allocation_stats *jsn_allocation_stats = NULL;
+
+/**
+ * Adds to one of the allocation statistics. Worker threads allocate as well,
+ * so they're added to atomically.
+ */
+static inline void jsn_allocation_count(size_t *counter, size_t amount) {
+#ifdef JSN_THREADS
+    atomic_fetch_add_explicit((_Atomic size_t *)counter, amount,
+                              memory_order_relaxed);
+#else
+    *counter += amount;
+#endif
+}
+
+static inline void *jsn_malloc(size_t size) {
+    if (jsn_allocation_stats != NULL) {
+        jsn_allocation_count(&jsn_allocation_stats->allocations, 1);
+        jsn_allocation_count(&jsn_allocation_stats->bytes, size);
+    }
+
+    return jsn_allocator.malloc(jsn_allocator.user_data, size);
+}
+
+static inline void *jsn_realloc(void *memory, size_t size) {
+    if (jsn_allocation_stats != NULL) {
+        // Growing nothing is a new allocation, which is freed as such.
+        if (memory == NULL) {
+            jsn_allocation_count(&jsn_allocation_stats->allocations, 1);
+        } else {
+            jsn_allocation_count(&jsn_allocation_stats->reallocations, 1);
+        }
+        jsn_allocation_count(&jsn_allocation_stats->bytes, size);
+    }
+
+    return jsn_allocator.realloc(jsn_allocator.user_data, memory, size);
+}
+
+static inline void *jsn_calloc(size_t count, size_t size) {
+    void *memory = jsn_malloc(count * size);
+
+    if (memory != NULL) {
+        memset(memory, 0, count * size);
+    }
+
+    return memory;
+}
+
+static inline void jsn_free_memory(void *memory) {
+    if (memory == NULL) {
+        return;
+    }
+
+    if (jsn_allocation_stats != NULL) {
+        jsn_allocation_count(&jsn_allocation_stats->frees, 1);
+    }
+
+    jsn_allocator.free(jsn_allocator.user_data, memory);
+}
+
+/* STATISTICS:
+ * --------------------------------------------------------------------------*/
+
+/*
+ * The parser's hot paths are only counted when compiling with JSN_STATS,
+ * otherwise the JSN_STATS_* macros expand to nothing. Counters are kept per
+ * thread, so work done on worker threads isn't included.
+ */
+
+#ifdef JSN_STATS
+static _Thread_local struct jsn_stats jsn_stats_counters;
+
+// The nesting depth of the value that's currently being parsed.
+static _Thread_local unsigned int jsn_stats_depth = 0;
+
+#define JSN_STATS_ADD(counter, amount) (jsn_stats_counters.counter += (amount))
+#define JSN_STATS_TOKEN(kind, bytes) jsn_stats_count_token((kind), (bytes))
+#define JSN_STATS_ENTER()                                                      \
+    do {                                                                       \
+        if (++jsn_stats_depth > jsn_stats_counters.max_depth) {               \
+            jsn_stats_counters.max_depth = jsn_stats_depth;                    \
+        }                                                                      \
+    } while (0)
+#define JSN_STATS_LEAVE() (jsn_stats_depth--)
+#else
+#define JSN_STATS_ADD(counter, amount) ((void)0)
+#define JSN_STATS_TOKEN(kind, bytes) ((void)0)
+#define JSN_STATS_ENTER() ((void)0)
+#define JSN_STATS_LEAVE() ((void)0)
+#endif
+
+/* SOURCES:
+ * --------------------------------------------------------------------------*/
+
+/**
+ * The contents of a JSON file, either memory mapped or read into the heap.
+ */
+struct jsn_source {
+    char *data;
+    size_t length;
+    bool mapped;
+};
+
+/**
+ * Reads the whole file into the heap.
+ */
+struct jsn_source jsn_source_read(FILE *file_ptr) {
+    struct jsn_source source = {NULL, 0, false};
+    size_t capacity = 65536;
+
+    source.data = jsn_malloc(capacity);
+    if (source.data == NULL) {
+        jsn_report_failure("Memory allocation failure.");
+    }
+
+    // The size isn't needed up front, so this also works for pipes.
+    size_t count;
+    while ((count = fread(&source.data[source.length], 1,
+                          capacity - source.length, file_ptr)) > 0) {
+        source.length += count;
+
+        if (source.length == capacity) {
+            capacity *= 2;
+            source.data = jsn_realloc(source.data, capacity);
+            if (source.data == NULL) {
+                jsn_report_failure("Memory allocation failure.");
+            }
+        }
+    }
+
+    return source;
+}
+
+/**
+ * Loads the given file, writable sources are private copy on write mappings
+ * so that they can be parsed in-situ.
+ */
+struct jsn_source jsn_source_load(const char *file_path, bool writable) {
+#ifdef JSN_MMAP
+    int file_descriptor = open(file_path, O_RDONLY);
+
+    if (file_descriptor == -1) {
+        jsn_report_failure("The file could not be opened, incorrect path?");
+    }
+
+    struct stat file_stat;
+    if (fstat(file_descriptor, &file_stat) == 0 &&
+        S_ISREG(file_stat.st_mode) && file_stat.st_size > 0) {
+        int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        void *data = mmap(NULL, file_stat.st_size, protection, MAP_PRIVATE,
+                          file_descriptor, 0);
+
+        if (data != MAP_FAILED) {
+            // The file is parsed from front to back, a single time.
+            madvise(data, file_stat.st_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+            madvise(data, file_stat.st_size, MADV_HUGEPAGE);
+#endif
+            close(file_descriptor);
+
+            struct jsn_source source = {data, file_stat.st_size, true};
+            return source;
+        }
+    }
+
+    // Empty and special files, or files that can't be mapped are read.
+    FILE *file_ptr = fdopen(file_descriptor, "r");
+#else
+    FILE *file_ptr = fopen(file_path, "r");
+#endif
+
+    if (file_ptr == NULL) {
+        jsn_report_failure("The file could not be opened, incorrect path?");
+    }
+
+    struct jsn_source source = jsn_source_read(file_ptr);
+    fclose(file_ptr);
+
+    return source;
+}
+
+void jsn_source_release(struct jsn_source *source) {
+#ifdef JSN_MMAP
+    if (source->mapped) {
+        munmap(source->data, source->length);
+    } else {
+        jsn_free_memory(source->data);
+    }
+#else
+    jsn_free_memory(source->data);
+#endif
+    source->data = NULL;
+    source->length = 0;
+}
+
+/* ARENA:
+ * --------------------------------------------------------------------------*/
+
+#define JSN_ARENA_BLOCK_SIZE 65536
+#define JSN_ARENA_ALIGNMENT 8
+#define JSN_ARENA_ALIGN(size)                                                  \
+    (((size) + JSN_ARENA_ALIGNMENT - 1) & ~(size_t)(JSN_ARENA_ALIGNMENT - 1))
+
+struct jsn_arena_block {
+    struct jsn_arena_block *next;
+    size_t size;
+    size_t used;
+    // The block's memory follows directly after the header.
+    char data[];
+};
+
+struct jsn_arena {
+    struct jsn_arena_block *blocks;
+    // The node that releases the arena when it gets freed. Documents built
+    // with the jsn_create_* functions have none, their top node (the one
+    // that's not attached to another of their nodes) releases it instead.
+    struct jsn_node *owner;
+    // Number of heap allocated nodes that are children of arena nodes.
+    unsigned int foreign_count;
+    // Loaded file that in-situ parsed strings point into.
+    struct jsn_source source;
+};
+
+// The arena used by the jsn_create_* functions while in arena mode.
+static _Thread_local struct jsn_arena *jsn_builder_arena = NULL;
+
+struct jsn_arena_block *jsn_arena_block_create(size_t size) {
+    struct jsn_arena_block *block =
+        jsn_malloc(sizeof(struct jsn_arena_block) + size);
+
+    // Check allocation success.
+    if (block == NULL) {
+        jsn_report_failure("Memory allocation failure.");
+        return NULL;
+    }
+
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+
+    return block;
+}
+
+void *jsn_arena_alloc(struct jsn_arena *arena, size_t size) {
+    // Keep all allocations aligned.
+    size = JSN_ARENA_ALIGN(size);
+
+    struct jsn_arena_block *head = arena->blocks;
+
+    if (head->used + size <= head->size) {
+        void *memory = &head->data[head->used];
+        head->used += size;
+        return memory;
+    }
+
+    // Large allocations get their own block, placed behind the current one
+    // so the remaining space of the current block is not wasted.
+    if (size > JSN_ARENA_BLOCK_SIZE / 4) {
+        struct jsn_arena_block *block = jsn_arena_block_create(size);
+        block->used = size;
+        block->next = head->next;
+        head->next = block;
+        return block->data;
+    }
+
+    // Start a new block.
+    struct jsn_arena_block *block =
+        jsn_arena_block_create(JSN_ARENA_BLOCK_SIZE);
+    block->used = size;
+    block->next = head;
+    arena->blocks = block;
+
+    return block->data;
+}
+
+struct jsn_arena *jsn_arena_create() {
+    struct jsn_arena_block *block =
+        jsn_arena_block_create(JSN_ARENA_BLOCK_SIZE);
+
+    // The arena's own header lives inside it's first block.
+    block->used = JSN_ARENA_ALIGN(sizeof(struct jsn_arena));
+
+    struct jsn_arena *arena = (struct jsn_arena *)block->data;
+    arena->blocks = block;
+    arena->owner = NULL;
+    arena->foreign_count = 0;
+    arena->source.data = NULL;
+    arena->source.length = 0;
+
+    return arena;
+}
+
+void jsn_arena_free(struct jsn_arena *arena) {
+    // Stop building into an arena that no longer exists.
+    if (jsn_builder_arena == arena) {
+        jsn_builder_arena = NULL;
+    }
+
+    if (arena->source.data != NULL) {
+        jsn_source_release(&arena->source);
+    }
+
+    struct jsn_arena_block *block = arena->blocks;
+    struct jsn_arena_block *next;
+
+    // The arena header is freed along with the last block.
+    while (block != NULL) {
+        next = block->next;
+        jsn_free_memory(block);
+        block = next;
+    }
+}
+
+/**
+ * Moves all blocks of an arena into another one, which then releases them.
+ * The moved arena can't be used anymore.
+ */
+void jsn_arena_merge(struct jsn_arena *arena, struct jsn_arena *other) {
+    struct jsn_arena_block *tail = other->blocks;
+    while (tail->next != NULL) {
+        tail = tail->next;
+    }
+
+    // Keep allocating from the arena's current block.
+    tail->next = arena->blocks->next;
+    arena->blocks->next = other->blocks;
+    arena->foreign_count += other->foreign_count;
+}
+
+/**
+ * Allocates memory from the given arena, or from the heap if no arena is
+ * provided.
+ */
+void *jsn_alloc(struct jsn_arena *arena, size_t size) {
+    if (arena != NULL) {
+        return jsn_arena_alloc(arena, size);
+    }
+
+    void *memory = jsn_malloc(size);
+
+    // Check allocation success.
+    if (memory == NULL) {
+        jsn_report_failure("Memory allocation failure.");
+        return NULL;
+    }
+
+    return memory;
+}
+
+/**
+ * Returns a null terminated copy of the given string, allocated from the given
+ * arena or from the heap if no arena is provided.
+ */
+char *jsn_copy_string(struct jsn_arena *arena, const char *source,
+                      size_t length) {
+    char *str = jsn_alloc(arena, length + 1);
+    memcpy(str, source, length);
+    str[length] = '\0';
+
+    return str;
+}
+
 /* TOKENIZER
  * --------------------------------------------------------------------------*/
 
@@ -49,20 +481,153 @@ struct jsn_token {
 
 struct jsn_tokenizer {
     char *source;
-    unsigned int source_cursor;
+    size_t source_length;
+    size_t source_cursor;
 };
 
+#ifdef JSN_STATS
+/**
+ * Counts a token of the given kind, that was read from the given number of
+ * source bytes.
+ */
+static inline void jsn_stats_count_token(enum jsn_token_kind kind,
+                                         size_t bytes) {
+    struct jsn_stats *stats = &jsn_stats_counters;
+    stats->bytes_scanned += bytes;
+
+    switch (kind) {
+    case JSN_TOC_INTEGER:
+        stats->integer_tokens++;
+        break;
+    case JSN_TOC_DOUBLE:
+        stats->double_tokens++;
+        break;
+    case JSN_TOC_STRING:
+        stats->string_tokens++;
+        break;
+    case JSN_TOC_BOOLEAN:
+        stats->boolean_tokens++;
+        break;
+    case JSN_TOC_NULL:
+        stats->null_tokens++;
+        break;
+    case JSN_TOC_OBJECT_OPEN:
+        stats->object_tokens++;
+        break;
+    case JSN_TOC_ARRAY_OPEN:
+        stats->array_tokens++;
+        break;
+    case JSN_TOC_OBJECT_CLOSE:
+    case JSN_TOC_ARRAY_CLOSE:
+        stats->close_tokens++;
+        break;
+    case JSN_TOC_COMMA:
+    case JSN_TOC_COLON:
+        stats->separator_tokens++;
+        break;
+    default:
+        break;
+    }
+}
+#endif
+
+/**
+ * Returns the address of the first quote, backslash or null terminator found
+ * between cursor and end. Returns end if there's none.
+ */
+typedef const char *(*jsn_string_scanner)(const char *cursor, const char *end);
+
+const char *jsn_scan_string_scalar(const char *cursor, const char *end) {
+    while (cursor != end) {
+        char c = *cursor;
+        if (c == '"' || c == '\\' || c == '\0') {
+            break;
+        }
+        cursor++;
+    }
+
+    return cursor;
+}
+
+#ifdef JSN_SIMD_X86
+const char *jsn_scan_string_sse2(const char *cursor, const char *end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i terminator = _mm_setzero_si128();
+
+    // Compare 16 bytes at a time, the remaining tail is scanned by hand.
+    while (end - cursor >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)cursor);
+        __m128i matches =
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                      _mm_cmpeq_epi8(chunk, backslash)),
+                         _mm_cmpeq_epi8(chunk, terminator));
+        int mask = _mm_movemask_epi8(matches);
+
+        if (mask != 0) {
+            return cursor + __builtin_ctz(mask);
+        }
+
+        cursor += 16;
+    }
+
+    return jsn_scan_string_scalar(cursor, end);
+}
+
+__attribute__((target("avx2"))) const char *
+jsn_scan_string_avx2(const char *cursor, const char *end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i terminator = _mm256_setzero_si256();
+
+    // Compare 32 bytes at a time, the remaining tail is left to SSE2.
+    while (end - cursor >= 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)cursor);
+        __m256i matches = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                            _mm256_cmpeq_epi8(chunk, backslash)),
+            _mm256_cmpeq_epi8(chunk, terminator));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(matches);
+
+        if (mask != 0) {
+            return cursor + __builtin_ctz(mask);
+        }
+
+        cursor += 32;
+    }
+
+    return jsn_scan_string_sse2(cursor, end);
+}
+#endif
+
+// The string scanner for this CPU, see jsn_resolve_kernels.
+#ifdef JSN_SIMD_X86
+static jsn_string_scanner jsn_scan_string_kernel = jsn_scan_string_sse2;
+#else
+static jsn_string_scanner jsn_scan_string_kernel = jsn_scan_string_scalar;
+#endif
+
+static inline const char *jsn_scan_string(const char *cursor,
+                                          const char *end) {
+    if (jsn_options & JSN_OPTION_SCALAR) {
+        return jsn_scan_string_scalar(cursor, end);
+    }
+
+    return jsn_scan_string_kernel(cursor, end);
+}
+
 /**
- * Source string needs to have a null terminator.
+ * Source string doesn't need a null terminator, reading past it's end yields
+ * null characters.
  */
 struct jsn_tokenizer
-jsn_tokenizer_init(char *source, unsigned int source_length, bool make_copy) {
+jsn_tokenizer_init(char *source, size_t source_length, bool make_copy) {
     // Construct tokenizer.
     struct jsn_tokenizer tokenizer;
 
     if (make_copy) {
         // Allocate for source string.
-        char *src = malloc(source_length);
+        char *src = jsn_malloc(source_length);
 
         // Check allocation success.
         if (src == NULL) {
@@ -70,18 +635,31 @@ jsn_tokenizer_init(char *source, unsigned int source_length, bool make_copy) {
         }
 
         // Copy over source string.
-        tokenizer.source = strcpy(src, source);
+        tokenizer.source = memcpy(src, source, source_length);
     } else {
         // Set the shared memory to the provided pointer.
         tokenizer.source = source;
     }
 
     // Set source string starting pointer and copy it into the tokenizer.
+    tokenizer.source_length = source_length;
     tokenizer.source_cursor = 0;
 
     return tokenizer;
 };
 
+/**
+ * Returns the character at the cursor, or a null character once the cursor
+ * has moved past the end of the source.
+ */
+static inline char jsn_tokenizer_peek(struct jsn_tokenizer *tokenizer) {
+    if (tokenizer->source_cursor >= tokenizer->source_length) {
+        return '\0';
+    }
+
+    return tokenizer->source[tokenizer->source_cursor];
+}
+
 static inline void jsn_token_set_lexeme_start(struct jsn_token *token,
                                               struct jsn_tokenizer *tokenizer) {
     token->lexeme_start = &tokenizer->source[tokenizer->source_cursor];
@@ -100,10 +678,11 @@ struct jsn_token jsn_tokenizer_get_next_token(struct jsn_tokenizer *tokenizer) {
     token.lexeme_start = NULL;
 
     // Keep the current token here.
-    char current_source_char = tokenizer->source[tokenizer->source_cursor];
+    char current_source_char = jsn_tokenizer_peek(tokenizer);
 
     // Just skip spaces.
     if (isspace(current_source_char) != 0) {
+        JSN_STATS_ADD(bytes_scanned, 1);
         tokenizer->source_cursor++;
         return jsn_tokenizer_get_next_token(tokenizer);
     }
@@ -116,41 +695,39 @@ struct jsn_token jsn_tokenizer_get_next_token(struct jsn_tokenizer *tokenizer) {
         // Set lexeme starting location.
         jsn_token_set_lexeme_start(&token, tokenizer);
 
-        // TODO: Make performance improvements here.
-        char current_char, next_char;
+        const char *cursor = &tokenizer->source[tokenizer->source_cursor];
+        const char *end = &tokenizer->source[tokenizer->source_length];
 
-        // This will keep adding bytes until the end of string is reached.
-        while (tokenizer->source[tokenizer->source_cursor] != '"') {
-            current_char = tokenizer->source[tokenizer->source_cursor];
-            next_char = tokenizer->source[tokenizer->source_cursor + 1];
+        // Jump from one quote or backslash to the next, until the end of the
+        // string is reached. Escapes are kept as is and handled during output.
+        while (true) {
+            cursor = jsn_scan_string(cursor, end);
 
-            // Maybe handle this during output?, yes.
-            // Handled escaping of backslashes.
-            if (current_char == '\\') {
-
-                // Skip escape char.
-                if (next_char == '\\') {
-                    tokenizer->source_cursor += 2;
-                    continue;
-                }
+            if (cursor == end || *cursor == '\0') {
+                jsn_report_failure("Unterminated string found!");
+                return token;
+            }
 
-                // Skip escape char.
-                if (next_char == '"') {
-                    tokenizer->source_cursor += 2;
-                    continue;
-                }
+            if (*cursor == '"') {
+                break;
             }
 
-            // Perform operation.
-            tokenizer->source_cursor++;
+            // Skip over the backslash and the escaped char.
+            cursor++;
+            if (cursor != end && *cursor != '\0') {
+                cursor++;
+            }
         }
 
+        tokenizer->source_cursor = cursor - tokenizer->source;
+
         // Set lexeme ending null terminator.
         jsn_token_set_lexeme_length(&token, tokenizer);
 
         // Move the past the ending quote.
         tokenizer->source_cursor++;
 
+        JSN_STATS_TOKEN(token.type, token.lexeme_length + 2);
         return token;
     }
 
@@ -166,21 +743,29 @@ struct jsn_token jsn_tokenizer_get_next_token(struct jsn_tokenizer *tokenizer) {
             tokenizer->source_cursor++;
         }
 
-        // TODO: Make performance improvements here.
-        char current_char = tokenizer->source[tokenizer->source_cursor];
+        char current_char = jsn_tokenizer_peek(tokenizer);
+        char previous_char = '\0';
 
-        while (isdigit(current_char) || current_char == '.') {
+        // Digits, fraction and exponent (1e5, -2.5E-3). A sign is only part
+        // of the number directly after the exponent marker.
+        while (isdigit(current_char) || current_char == '.' ||
+               current_char == 'e' || current_char == 'E' ||
+               ((current_char == '-' || current_char == '+') &&
+                (previous_char == 'e' || previous_char == 'E'))) {
             // Set this if it's a double.
-            if (current_char == '.') {
+            if (current_char == '.' || current_char == 'e' ||
+                current_char == 'E') {
                 token.type = JSN_TOC_DOUBLE;
             }
 
             tokenizer->source_cursor++;
-            current_char = tokenizer->source[tokenizer->source_cursor];
+            previous_char = current_char;
+            current_char = jsn_tokenizer_peek(tokenizer);
         }
 
         // Set lexeme ending null terminator.
         jsn_token_set_lexeme_length(&token, tokenizer);
+        JSN_STATS_TOKEN(token.type, token.lexeme_length);
         return token;
     }
 
@@ -200,6 +785,7 @@ struct jsn_token jsn_tokenizer_get_next_token(struct jsn_tokenizer *tokenizer) {
     case 'n':
         token.type = JSN_TOC_NULL;
         tokenizer->source_cursor += 4; // null, 1234
+        JSN_STATS_TOKEN(token.type, 4);
         return token;
     case '[':
         token.type = JSN_TOC_ARRAY_OPEN;
@@ -231,567 +817,6414 @@ struct jsn_token jsn_tokenizer_get_next_token(struct jsn_tokenizer *tokenizer) {
     }
 
     jsn_token_set_lexeme_length(&token, tokenizer);
+    JSN_STATS_TOKEN(token.type, token.lexeme_length);
 
     return token;
 }
 
-/* TREE DATA STRUCTURE:
+/* STRUCTURAL INDEX:
  * --------------------------------------------------------------------------*/
 
-enum jsn_node_type {
-    JSN_NODE_NULL,
-    JSN_NODE_INTEGER,
-    JSN_NODE_DOUBLE,
-    JSN_NODE_BOOLEAN,
-    JSN_NODE_STRING,
-    JSN_NODE_ARRAY,
-    JSN_NODE_OBJECT,
-};
+/*
+ * The two stage parse mode first indexes the positions of all structural
+ * characters ({}[]:,), quotes and the starts of all other values in one
+ * vectorized pass over the source, and then walks that index to build the
+ * tree. The source is classified in blocks of 64 bytes, each byte maps to one
+ * bit of the block's masks.
+ */
 
-union jsn_node_value {
-    int value_integer;
-    double value_double;
-    bool value_boolean;
-    char *value_string;
+#define JSN_BLOCK_SIZE 64
+
+struct jsn_block_masks {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t operators;
+    uint64_t whitespace;
 };
 
-struct jsn_node {
-    char *key;
-    union jsn_node_value value;
-    struct jsn_node **children;
-    enum jsn_node_type type;
-    unsigned int children_count;
+struct jsn_structural_index {
+    unsigned int *positions;
+    unsigned int count;
+    unsigned int capacity;
+    // The next position to be handed out to the parser.
+    unsigned int next;
 };
 
-struct jsn_node *jsn_create_node(enum jsn_node_type type) {
-    // Let's allocate some memory on the heap.
-    struct jsn_node *node = malloc(sizeof(struct jsn_node));
+typedef void (*jsn_block_classifier)(const char *block,
+                                     struct jsn_block_masks *masks);
 
-    // Check allocation success.
-    if (node == NULL) {
-        jsn_report_failure("Memory allocation failure.");
-        return NULL;
-    }
+void jsn_classify_block_scalar(const char *block,
+                               struct jsn_block_masks *masks) {
+    memset(masks, 0, sizeof(struct jsn_block_masks));
 
-    // Set some sane defaults.
-    node->key = NULL;
-    node->type = type;
-    node->children_count = 0;
-    node->children = NULL;
+    for (unsigned int i = 0; i < JSN_BLOCK_SIZE; i++) {
+        uint64_t bit = (uint64_t)1 << i;
 
-    return node;
+        switch (block[i]) {
+        case '"':
+            masks->quote |= bit;
+            break;
+        case '\\':
+            masks->backslash |= bit;
+            break;
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ':':
+        case ',':
+            masks->operators |= bit;
+            break;
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            masks->whitespace |= bit;
+            break;
+        }
+    }
 }
 
-void jsn_append_node_child(struct jsn_node *parent, struct jsn_node *child) {
-    // Increment children count.
-    parent->children_count++;
-
-    // Reallocate memory.
-    unsigned int size = (sizeof(struct jsn_node *)) * (parent->children_count);
-    parent->children = realloc(parent->children, size);
-
-    // Set the new node.
-    parent->children[parent->children_count - 1] = child;
+#ifdef JSN_SIMD_X86
+void jsn_classify_block_sse2(const char *block, struct jsn_block_masks *masks) {
+    memset(masks, 0, sizeof(struct jsn_block_masks));
+
+    for (unsigned int i = 0; i < JSN_BLOCK_SIZE; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)&block[i]);
+
+        // Setting bit 0x20 maps [ to { and ] to }.
+        __m128i lowered = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+        __m128i operators = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(lowered, _mm_set1_epi8('{')),
+                         _mm_cmpeq_epi8(lowered, _mm_set1_epi8('}'))),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(':')),
+                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8(','))));
+        __m128i whitespace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')),
+                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))));
+
+        masks->quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')))
+                        << i;
+        masks->backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                                _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')))
+                            << i;
+        masks->operators |= (uint64_t)(uint16_t)_mm_movemask_epi8(operators)
+                           << i;
+        masks->whitespace |= (uint64_t)(uint16_t)_mm_movemask_epi8(whitespace)
+                             << i;
+    }
 }
 
-void jsn_free_node_children(struct jsn_node *node) {
-    // When the node has no children.
-    if (node->children_count == 0) {
-        return;
+__attribute__((target("avx2"))) void
+jsn_classify_block_avx2(const char *block, struct jsn_block_masks *masks) {
+    memset(masks, 0, sizeof(struct jsn_block_masks));
+
+    for (unsigned int i = 0; i < JSN_BLOCK_SIZE; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)&block[i]);
+
+        // Setting bit 0x20 maps [ to { and ] to }.
+        __m256i lowered = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+        __m256i operators = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(lowered, _mm256_set1_epi8('{')),
+                            _mm256_cmpeq_epi8(lowered, _mm256_set1_epi8('}'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(':')),
+                            _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(','))));
+        __m256i whitespace = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                            _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')),
+                            _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r'))));
+
+        masks->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                            _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"')))
+                        << i;
+        masks->backslash |=
+            (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\')))
+            << i;
+        masks->operators |=
+            (uint64_t)(uint32_t)_mm256_movemask_epi8(operators) << i;
+        masks->whitespace |=
+            (uint64_t)(uint32_t)_mm256_movemask_epi8(whitespace) << i;
+    }
+}
+#endif
+
+// The block classifier for this CPU, see jsn_resolve_kernels.
+#ifdef JSN_SIMD_X86
+static jsn_block_classifier jsn_classify_block_kernel =
+    jsn_classify_block_sse2;
+#else
+static jsn_block_classifier jsn_classify_block_kernel =
+    jsn_classify_block_scalar;
+#endif
+
+#ifdef JSN_SIMD_X86
+/**
+ * Picks the fastest kernels supported by the CPU. It runs when the library is
+ * loaded, before there are any threads, so that parsing only ever reads the
+ * kernels and can be done from multiple threads at once.
+ */
+__attribute__((constructor)) static void jsn_resolve_kernels() {
+    if (jsn_cpu_has_avx2()) {
+        jsn_scan_string_kernel = jsn_scan_string_avx2;
+        jsn_classify_block_kernel = jsn_classify_block_avx2;
     }
+}
+#endif
 
-    // For each child node, starting at the very end.
-    for (unsigned int i = 0; i < node->children_count; i++) {
-        // If it's a string, free it.
-        if (node->children[i]->type == JSN_NODE_STRING) {
-            free(node->children[i]->value.value_string);
-        }
+/**
+ * Returns a mask of the characters that are escaped by a backslash. Escapes
+ * are rare, so they are simply walked one by one. The carry holds whether the
+ * first character of the next block is escaped.
+ */
+static inline uint64_t jsn_find_escaped(uint64_t backslash, uint64_t *carry) {
+    uint64_t escaped = *carry;
+    uint64_t escapes = backslash & ~escaped;
+    *carry = 0;
+
+    while (escapes != 0) {
+        unsigned int i = __builtin_ctzll(escapes);
+        escapes &= escapes - 1;
 
-        // If it has a key, free it.
-        if (node->children[i]->key != NULL) {
-            free(node->children[i]->key);
+        if (i == JSN_BLOCK_SIZE - 1) {
+            *carry = 1;
+            break;
         }
 
-        // If this node has children, free it's taken resources.
-        if (node->children[i]->children_count > 0) {
-            // This node also has it's own children, so recursively continue.
-            jsn_free_node_children(node->children[i]);
+        // The escaped character can't be an escape itself.
+        escaped |= (uint64_t)1 << (i + 1);
+        escapes &= ~((uint64_t)1 << (i + 1));
+    }
+
+    return escaped;
+}
+
+/**
+ * Sets every bit that has an odd number of set bits at or below it, which
+ * turns a mask of quotes into a mask of the string regions they enclose.
+ */
+static inline uint64_t jsn_prefix_xor(uint64_t mask) {
+    mask ^= mask << 1;
+    mask ^= mask << 2;
+    mask ^= mask << 4;
+    mask ^= mask << 8;
+    mask ^= mask << 16;
+    mask ^= mask << 32;
+
+    return mask;
+}
+
+/**
+ * Stage 1 of the two stage parse mode, indexes the positions of all
+ * structural characters, quotes and value starts outside of strings.
+ */
+void jsn_structural_index_build(struct jsn_structural_index *index,
+                                const char *source, unsigned int length) {
+    jsn_block_classifier classify = jsn_classify_block_kernel;
+    if (jsn_options & JSN_OPTION_SCALAR) {
+        classify = jsn_classify_block_scalar;
+    }
+
+    index->positions = NULL;
+    index->count = 0;
+    index->capacity = 0;
+    index->next = 0;
+
+    // Stage 1 scans every byte, stage 2 only reads the indexed positions.
+    JSN_STATS_ADD(bytes_scanned, length);
+
+    // State that's carried over from one block to the next.
+    uint64_t escaped_carry = 0;
+    uint64_t in_string_carry = 0;
+    uint64_t scalar_carry = 0;
+
+    struct jsn_block_masks masks;
+    char padded_block[JSN_BLOCK_SIZE];
+
+    for (unsigned int offset = 0; offset < length; offset += JSN_BLOCK_SIZE) {
+        const char *block = &source[offset];
+
+        // The last block is padded with spaces.
+        if (length - offset < JSN_BLOCK_SIZE) {
+            memset(padded_block, ' ', JSN_BLOCK_SIZE);
+            memcpy(padded_block, block, length - offset);
+            block = padded_block;
+        }
 
-            // Now free all the memory taken by this nodes children.
-            free(node->children[i]->children);
-            node->children[i]->children = NULL;
-            node->children[i]->children_count = 0;
+        classify(block, &masks);
+
+        // Find the quotes that are not escaped, the regions between them are
+        // strings. The opening quote is part of the string region, the
+        // closing quote is not.
+        uint64_t escaped = jsn_find_escaped(masks.backslash, &escaped_carry);
+        uint64_t quotes = masks.quote & ~escaped;
+        uint64_t in_string = jsn_prefix_xor(quotes) ^ in_string_carry;
+        in_string_carry = (uint64_t)((int64_t)in_string >> 63);
+
+        // Values that aren't strings start after an operator or whitespace.
+        uint64_t scalar = ~(masks.operators | masks.whitespace | masks.quote);
+        uint64_t scalar_starts = scalar & ~((scalar << 1) | scalar_carry);
+        scalar_carry = scalar >> 63;
+
+        uint64_t structurals =
+            ((masks.operators | scalar_starts) & ~in_string) | quotes;
+
+        // Make sure there's space for every bit of the block.
+        if (index->count + JSN_BLOCK_SIZE > index->capacity) {
+            index->capacity = index->capacity == 0
+                                  ? length / 4 + JSN_BLOCK_SIZE
+                                  : index->capacity * 2;
+            index->positions =
+                jsn_realloc(index->positions,
+                            sizeof(unsigned int) * index->capacity);
+
+            // Check allocation success.
+            if (index->positions == NULL) {
+                jsn_report_failure("Memory allocation failure.");
+                return;
+            }
         }
 
-        // We need to also free this child.
-        free(node->children[i]);
+        while (structurals != 0) {
+            index->positions[index->count++] =
+                offset + __builtin_ctzll(structurals);
+            structurals &= structurals - 1;
+        }
     }
+}
 
-    // Now we can free this parents data.
-    free(node->children);
-    node->children = NULL;
-    node->children_count = 0;
+void jsn_structural_index_free(struct jsn_structural_index *index) {
+    jsn_free_memory(index->positions);
+    index->positions = NULL;
+    index->count = 0;
+    index->capacity = 0;
 }
 
-void jsn_free_node_members(struct jsn_node *node, bool keep_key) {
-    // If it's a string, free it.
-    if (node->type == JSN_NODE_STRING) {
-        free(node->value.value_string);
-        node->value.value_string = NULL;
+/**
+ * Stage 2 of the two stage parse mode, returns the token at the next indexed
+ * position. Strings are bounded by their indexed quotes, so they don't need
+ * to be scanned again.
+ */
+struct jsn_token
+jsn_tokenizer_get_indexed_token(struct jsn_tokenizer *tokenizer,
+                                struct jsn_structural_index *index) {
+    struct jsn_token token;
+    token.type = JSN_TOC_UNKNOWN;
+    token.lexeme_start = NULL;
+
+    // The original tokenizer would run into the null terminator here.
+    if (index->next == index->count) {
+        jsn_report_failure("Unknown token found!");
+        return token;
     }
 
-    // If it has a key we also need to free that.
-    if (node->key != NULL && keep_key == false) {
-        free(node->key);
-        node->key = NULL;
+    unsigned int position = index->positions[index->next++];
+    token.lexeme_start = &tokenizer->source[position];
+    token.lexeme_length = 1;
+    tokenizer->source_cursor = position + 1;
+
+    // Structural characters map directly to their tokens, other values are
+    // left to the regular tokenizer.
+    switch (tokenizer->source[position]) {
+    case '{':
+        token.type = JSN_TOC_OBJECT_OPEN;
+        JSN_STATS_TOKEN(token.type, 0);
+        return token;
+    case '}':
+        token.type = JSN_TOC_OBJECT_CLOSE;
+        JSN_STATS_TOKEN(token.type, 0);
+        return token;
+    case '[':
+        token.type = JSN_TOC_ARRAY_OPEN;
+        JSN_STATS_TOKEN(token.type, 0);
+        return token;
+    case ']':
+        token.type = JSN_TOC_ARRAY_CLOSE;
+        JSN_STATS_TOKEN(token.type, 0);
+        return token;
+    case ',':
+        token.type = JSN_TOC_COMMA;
+        JSN_STATS_TOKEN(token.type, 0);
+        return token;
+    case ':':
+        token.type = JSN_TOC_COLON;
+        JSN_STATS_TOKEN(token.type, 0);
+        return token;
+    case '"':
+        break;
+    default:
+        tokenizer->source_cursor = position;
+        return jsn_tokenizer_get_next_token(tokenizer);
     }
 
-    // We also need to free it's children.
-    if (node->children_count != 0) {
-        jsn_free_node_children(node);
+    // The closing quote is always the next position.
+    if (index->next == index->count) {
+        jsn_report_failure("Unterminated string found!");
+        return token;
     }
+
+    unsigned int closing = index->positions[index->next++];
+
+    token.type = JSN_TOC_STRING;
+    token.lexeme_start = &tokenizer->source[position + 1];
+    token.lexeme_length = closing - position - 1;
+    tokenizer->source_cursor = closing + 1;
+
+    JSN_STATS_TOKEN(token.type, 0);
+    return token;
 }
 
-void jsn_free_node(struct jsn_node *node) {
-    // Free all it's members.
-    jsn_free_node_members(node, false);
+/* NUMBERS:
+ * --------------------------------------------------------------------------*/
+
+/*
+ * Numbers are converted straight from the lexeme, without copying it. Doubles
+ * use the Clinger fast path when the result is exact, and the Eisel-Lemire
+ * algorithm otherwise. The rare cases that neither can round correctly are
+ * left to strtod.
+ */
+
+#define JSN_POWERS_OF_TEN_MIN_EXP10 -342
+#define JSN_POWERS_OF_TEN_MAX_EXP10 308
+#define JSN_MAX_SIGNIFICANT_DIGITS 19
+
+// The 128 most significant bits of 10^e (rounded down), for e from -342 up to
+// and including 308. Each entry holds the high and low 64 bits.
+static const uint64_t jsn_powers_of_ten[][2] = {
+    {0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL},
+    {0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL},
+    {0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL},
+    {0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL},
+    {0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL},
+    {0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL},
+    {0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL},
+    {0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL},
+    {0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL},
+    {0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL},
+    {0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL},
+    {0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL},
+    {0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL},
+    {0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL},
+    {0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL},
+    {0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL},
+    {0x84a57695fe98746dULL, 0x014bb630f7604b57ULL},
+    {0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL},
+    {0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL},
+    {0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL},
+    {0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL},
+    {0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL},
+    {0xfd00b897478238d0ULL, 0x8920b098955522b4ULL},
+    {0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL},
+    {0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL},
+    {0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL},
+    {0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL},
+    {0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL},
+    {0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL},
+    {0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL},
+    {0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL},
+    {0xeba09271e88d976bULL, 0xf7864a44c633682eULL},
+    {0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL},
+    {0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL},
+    {0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL},
+    {0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL},
+    {0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL},
+    {0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL},
+    {0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL},
+    {0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL},
+    {0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL},
+    {0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL},
+    {0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL},
+    {0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL},
+    {0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL},
+    {0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL},
+    {0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL},
+    {0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL},
+    {0xa37fce126597973cULL, 0xe50ff107bab528a0ULL},
+    {0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL},
+    {0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL},
+    {0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL},
+    {0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL},
+    {0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL},
+    {0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL},
+    {0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL},
+    {0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL},
+    {0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL},
+    {0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL},
+    {0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL},
+    {0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL},
+    {0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL},
+    {0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL},
+    {0x91376c36d99995beULL, 0x23100809b9c21fa1ULL},
+    {0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL},
+    {0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL},
+    {0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL},
+    {0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL},
+    {0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL},
+    {0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL},
+    {0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL},
+    {0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL},
+    {0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL},
+    {0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL},
+    {0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL},
+    {0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL},
+    {0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL},
+    {0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL},
+    {0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL},
+    {0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL},
+    {0xc987434744ac874eULL, 0xa327ffb266b56220ULL},
+    {0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL},
+    {0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL},
+    {0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL},
+    {0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL},
+    {0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL},
+    {0xc0314325637a1939ULL, 0xfa911155fefb5308ULL},
+    {0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL},
+    {0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL},
+    {0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL},
+    {0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL},
+    {0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL},
+    {0xb749faed14125d36ULL, 0xcef980ec671f667bULL},
+    {0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL},
+    {0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL},
+    {0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL},
+    {0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL},
+    {0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL},
+    {0xaecc49914078536dULL, 0x58fae9f773886e18ULL},
+    {0xda7f5bf590966848ULL, 0xaf39a475506a899eULL},
+    {0x888f99797a5e012dULL, 0x6d8406c952429603ULL},
+    {0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL},
+    {0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL},
+    {0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL},
+    {0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL},
+    {0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL},
+    {0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL},
+    {0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL},
+    {0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL},
+    {0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL},
+    {0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL},
+    {0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL},
+    {0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL},
+    {0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL},
+    {0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL},
+    {0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL},
+    {0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL},
+    {0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL},
+    {0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL},
+    {0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL},
+    {0xb913179899f68584ULL, 0x28e2557b59846e3fULL},
+    {0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL},
+    {0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL},
+    {0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL},
+    {0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL},
+    {0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL},
+    {0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL},
+    {0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL},
+    {0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL},
+    {0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL},
+    {0xd77485cb25823ac7ULL, 0x7d633293366b828bULL},
+    {0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL},
+    {0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL},
+    {0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL},
+    {0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL},
+    {0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL},
+    {0xcd795be870516656ULL, 0x67902e276c921f8bULL},
+    {0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL},
+    {0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL},
+    {0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL},
+    {0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL},
+    {0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL},
+    {0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL},
+    {0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL},
+    {0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL},
+    {0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL},
+    {0xef340a98172aace4ULL, 0x86fb897116c87c34ULL},
+    {0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL},
+    {0xbae0a846d2195712ULL, 0x8974836059cca109ULL},
+    {0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL},
+    {0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL},
+    {0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL},
+    {0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL},
+    {0x8e938662882af53eULL, 0x547eb47b7282ee9cULL},
+    {0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL},
+    {0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL},
+    {0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL},
+    {0xae0b158b4738705eULL, 0x9624ab50b148d445ULL},
+    {0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL},
+    {0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL},
+    {0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL},
+    {0xd47487cc8470652bULL, 0x7647c3200069671fULL},
+    {0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL},
+    {0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL},
+    {0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL},
+    {0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL},
+    {0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL},
+    {0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL},
+    {0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL},
+    {0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL},
+    {0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL},
+    {0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL},
+    {0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL},
+    {0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL},
+    {0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL},
+    {0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL},
+    {0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL},
+    {0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL},
+    {0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL},
+    {0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL},
+    {0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL},
+    {0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL},
+    {0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL},
+    {0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL},
+    {0x8c974f7383725573ULL, 0x1e414218c73a13fbULL},
+    {0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL},
+    {0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL},
+    {0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL},
+    {0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL},
+    {0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL},
+    {0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL},
+    {0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL},
+    {0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL},
+    {0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL},
+    {0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL},
+    {0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL},
+    {0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL},
+    {0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL},
+    {0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL},
+    {0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL},
+    {0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL},
+    {0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL},
+    {0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL},
+    {0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL},
+    {0xbe89523386091465ULL, 0xf6bbb397f1135823ULL},
+    {0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL},
+    {0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL},
+    {0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL},
+    {0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL},
+    {0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL},
+    {0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL},
+    {0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL},
+    {0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL},
+    {0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL},
+    {0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL},
+    {0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL},
+    {0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL},
+    {0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL},
+    {0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL},
+    {0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL},
+    {0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL},
+    {0x843610cb4bf160cbULL, 0xcedf722a585139baULL},
+    {0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL},
+    {0xce947a3da6a9273eULL, 0x733d226229feea32ULL},
+    {0x811ccc668829b887ULL, 0x0806357d5a3f525fULL},
+    {0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL},
+    {0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL},
+    {0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL},
+    {0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL},
+    {0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL},
+    {0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL},
+    {0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL},
+    {0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL},
+    {0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL},
+    {0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL},
+    {0xbbe226efb628afeaULL, 0x890489f70a55368bULL},
+    {0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL},
+    {0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL},
+    {0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL},
+    {0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL},
+    {0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL},
+    {0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL},
+    {0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL},
+    {0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL},
+    {0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL},
+    {0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL},
+    {0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL},
+    {0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL},
+    {0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL},
+    {0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL},
+    {0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL},
+    {0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL},
+    {0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL},
+    {0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL},
+    {0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL},
+    {0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL},
+    {0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL},
+    {0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL},
+    {0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL},
+    {0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL},
+    {0xc24452da229b021bULL, 0xfbe85badce996168ULL},
+    {0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL},
+    {0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL},
+    {0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL},
+    {0xed246723473e3813ULL, 0x290123e9aab23b68ULL},
+    {0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL},
+    {0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL},
+    {0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL},
+    {0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL},
+    {0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL},
+    {0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL},
+    {0x8d590723948a535fULL, 0x579c487e5a38ad0eULL},
+    {0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL},
+    {0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL},
+    {0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL},
+    {0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL},
+    {0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL},
+    {0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL},
+    {0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL},
+    {0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL},
+    {0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL},
+    {0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL},
+    {0xcdb02555653131b6ULL, 0x3792f412cb06794dULL},
+    {0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL},
+    {0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL},
+    {0xc8de047564d20a8bULL, 0xf245825a5a445275ULL},
+    {0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL},
+    {0x9ced737bb6c4183dULL, 0x55464dd69685606bULL},
+    {0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL},
+    {0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL},
+    {0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL},
+    {0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL},
+    {0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL},
+    {0x95a8637627989aadULL, 0xdde7001379a44aa8ULL},
+    {0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL},
+    {0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL},
+    {0x9226712162ab070dULL, 0xcab3961304ca70e8ULL},
+    {0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL},
+    {0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL},
+    {0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL},
+    {0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL},
+    {0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL},
+    {0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL},
+    {0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL},
+    {0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL},
+    {0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL},
+    {0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL},
+    {0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL},
+    {0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL},
+    {0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL},
+    {0xcfb11ead453994baULL, 0x67de18eda5814af2ULL},
+    {0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL},
+    {0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL},
+    {0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL},
+    {0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL},
+    {0x9e74d1b791e07e48ULL, 0x775ea264cf55347dULL},
+    {0xc612062576589ddaULL, 0x95364afe032a819dULL},
+    {0xf79687aed3eec551ULL, 0x3a83ddbd83f52204ULL},
+    {0x9abe14cd44753b52ULL, 0xc4926a9672793542ULL},
+    {0xc16d9a0095928a27ULL, 0x75b7053c0f178293ULL},
+    {0xf1c90080baf72cb1ULL, 0x5324c68b12dd6338ULL},
+    {0x971da05074da7beeULL, 0xd3f6fc16ebca5e03ULL},
+    {0xbce5086492111aeaULL, 0x88f4bb1ca6bcf584ULL},
+    {0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e5ULL},
+    {0x9392ee8e921d5d07ULL, 0x3aff322e62439fcfULL},
+    {0xb877aa3236a4b449ULL, 0x09befeb9fad487c2ULL},
+    {0xe69594bec44de15bULL, 0x4c2ebe687989a9b3ULL},
+    {0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a10ULL},
+    {0xb424dc35095cd80fULL, 0x538484c19ef38c94ULL},
+    {0xe12e13424bb40e13ULL, 0x2865a5f206b06fb9ULL},
+    {0x8cbccc096f5088cbULL, 0xf93f87b7442e45d3ULL},
+    {0xafebff0bcb24aafeULL, 0xf78f69a51539d748ULL},
+    {0xdbe6fecebdedd5beULL, 0xb573440e5a884d1bULL},
+    {0x89705f4136b4a597ULL, 0x31680a88f8953030ULL},
+    {0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3dULL},
+    {0xd6bf94d5e57a42bcULL, 0x3d32907604691b4cULL},
+    {0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b10fULL},
+    {0xa7c5ac471b478423ULL, 0x0fcf80dc33721d53ULL},
+    {0xd1b71758e219652bULL, 0xd3c36113404ea4a8ULL},
+    {0x83126e978d4fdf3bULL, 0x645a1cac083126e9ULL},
+    {0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a3ULL},
+    {0xccccccccccccccccULL, 0xccccccccccccccccULL},
+    {0x8000000000000000ULL, 0x0000000000000000ULL},
+    {0xa000000000000000ULL, 0x0000000000000000ULL},
+    {0xc800000000000000ULL, 0x0000000000000000ULL},
+    {0xfa00000000000000ULL, 0x0000000000000000ULL},
+    {0x9c40000000000000ULL, 0x0000000000000000ULL},
+    {0xc350000000000000ULL, 0x0000000000000000ULL},
+    {0xf424000000000000ULL, 0x0000000000000000ULL},
+    {0x9896800000000000ULL, 0x0000000000000000ULL},
+    {0xbebc200000000000ULL, 0x0000000000000000ULL},
+    {0xee6b280000000000ULL, 0x0000000000000000ULL},
+    {0x9502f90000000000ULL, 0x0000000000000000ULL},
+    {0xba43b74000000000ULL, 0x0000000000000000ULL},
+    {0xe8d4a51000000000ULL, 0x0000000000000000ULL},
+    {0x9184e72a00000000ULL, 0x0000000000000000ULL},
+    {0xb5e620f480000000ULL, 0x0000000000000000ULL},
+    {0xe35fa931a0000000ULL, 0x0000000000000000ULL},
+    {0x8e1bc9bf04000000ULL, 0x0000000000000000ULL},
+    {0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL},
+    {0xde0b6b3a76400000ULL, 0x0000000000000000ULL},
+    {0x8ac7230489e80000ULL, 0x0000000000000000ULL},
+    {0xad78ebc5ac620000ULL, 0x0000000000000000ULL},
+    {0xd8d726b7177a8000ULL, 0x0000000000000000ULL},
+    {0x878678326eac9000ULL, 0x0000000000000000ULL},
+    {0xa968163f0a57b400ULL, 0x0000000000000000ULL},
+    {0xd3c21bcecceda100ULL, 0x0000000000000000ULL},
+    {0x84595161401484a0ULL, 0x0000000000000000ULL},
+    {0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL},
+    {0xcecb8f27f4200f3aULL, 0x0000000000000000ULL},
+    {0x813f3978f8940984ULL, 0x4000000000000000ULL},
+    {0xa18f07d736b90be5ULL, 0x5000000000000000ULL},
+    {0xc9f2c9cd04674edeULL, 0xa400000000000000ULL},
+    {0xfc6f7c4045812296ULL, 0x4d00000000000000ULL},
+    {0x9dc5ada82b70b59dULL, 0xf020000000000000ULL},
+    {0xc5371912364ce305ULL, 0x6c28000000000000ULL},
+    {0xf684df56c3e01bc6ULL, 0xc732000000000000ULL},
+    {0x9a130b963a6c115cULL, 0x3c7f400000000000ULL},
+    {0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL},
+    {0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL},
+    {0x96769950b50d88f4ULL, 0x1314448000000000ULL},
+    {0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL},
+    {0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL},
+    {0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL},
+    {0xb7abc627050305adULL, 0xf14a3d9e40000000ULL},
+    {0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL},
+    {0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL},
+    {0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL},
+    {0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL},
+    {0x8c213d9da502de45ULL, 0x4526f422cc340000ULL},
+    {0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL},
+    {0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL},
+    {0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL},
+    {0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL},
+    {0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL},
+    {0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL},
+    {0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL},
+    {0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL},
+    {0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL},
+    {0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL},
+    {0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL},
+    {0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL},
+    {0x9f4f2726179a2245ULL, 0x01d762422c946590ULL},
+    {0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL},
+    {0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL},
+    {0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL},
+    {0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL},
+    {0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL},
+    {0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL},
+    {0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL},
+    {0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL},
+    {0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL},
+    {0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL},
+    {0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL},
+    {0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL},
+    {0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL},
+    {0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL},
+    {0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL},
+    {0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL},
+    {0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL},
+    {0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL},
+    {0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL},
+    {0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL},
+    {0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL},
+    {0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL},
+    {0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL},
+    {0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL},
+    {0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL},
+    {0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL},
+    {0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL},
+    {0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL},
+    {0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL},
+    {0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL},
+    {0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL},
+    {0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL},
+    {0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL},
+    {0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL},
+    {0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL},
+    {0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL},
+    {0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL},
+    {0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL},
+    {0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL},
+    {0x924d692ca61be758ULL, 0x593c2626705f9c56ULL},
+    {0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL},
+    {0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL},
+    {0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL},
+    {0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL},
+    {0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL},
+    {0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL},
+    {0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL},
+    {0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL},
+    {0x884134fe908658b2ULL, 0x3109058d147fdcddULL},
+    {0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL},
+    {0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL},
+    {0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL},
+    {0xa6539930bf6bff45ULL, 0x84db8346b786151cULL},
+    {0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL},
+    {0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL},
+    {0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL},
+    {0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL},
+    {0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL},
+    {0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL},
+    {0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL},
+    {0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL},
+    {0x9ae757596946075fULL, 0x3375788de9b06958ULL},
+    {0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL},
+    {0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL},
+    {0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL},
+    {0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL},
+    {0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL},
+    {0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL},
+    {0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL},
+    {0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL},
+    {0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL},
+    {0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL},
+    {0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL},
+    {0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL},
+    {0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL},
+    {0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL},
+    {0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL},
+    {0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL},
+    {0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL},
+    {0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL},
+    {0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL},
+    {0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL},
+    {0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL},
+    {0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL},
+    {0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL},
+    {0x802221226be55a64ULL, 0xc2494954da2c9789ULL},
+    {0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL},
+    {0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL},
+    {0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL},
+    {0x9c69a97284b578d7ULL, 0xff2a760414536efbULL},
+    {0xc38413cf25e2d70dULL, 0xfef5138519684abaULL},
+    {0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL},
+    {0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL},
+    {0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL},
+    {0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL},
+    {0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL},
+    {0xba756174393d88dfULL, 0x94f971119aeef9e4ULL},
+    {0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL},
+    {0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL},
+    {0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL},
+    {0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL},
+    {0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL},
+    {0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL},
+    {0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL},
+    {0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL},
+    {0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL},
+    {0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL},
+    {0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL},
+    {0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL},
+    {0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL},
+    {0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL},
+    {0xa59bc234db398c25ULL, 0x43fab9837e699095ULL},
+    {0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL},
+    {0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL},
+    {0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL},
+    {0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL},
+    {0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL},
+    {0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL},
+    {0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL},
+    {0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL},
+    {0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL},
+    {0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL},
+    {0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL},
+    {0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL},
+    {0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL},
+    {0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL},
+    {0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL},
+    {0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL},
+    {0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL},
+    {0x8fa475791a569d10ULL, 0xf96e017d694487bcULL},
+    {0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL},
+    {0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL},
+    {0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL},
+    {0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL},
+    {0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL},
+    {0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL},
+    {0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL},
+    {0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL},
+    {0x85c7056562757456ULL, 0xf6872d5667844e49ULL},
+    {0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL},
+    {0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL},
+    {0x82a45b450226b39cULL, 0xecc0024661173473ULL},
+    {0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL},
+    {0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL},
+    {0xff290242c83396ceULL, 0x7e67047175a15271ULL},
+    {0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL},
+    {0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL},
+    {0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL},
+    {0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL},
+    {0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL},
+    {0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL},
+    {0x98165af37b2153deULL, 0xc3727a337a8b704aULL},
+    {0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL},
+    {0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL},
+    {0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL},
+    {0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL},
+    {0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL},
+    {0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL},
+    {0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL},
+    {0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL},
+    {0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL},
+    {0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL},
+    {0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL},
+    {0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL},
+    {0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL},
+    {0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL},
+    {0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL},
+    {0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL},
+    {0xd31045a8341ca07cULL, 0x1ede48111209a050ULL},
+    {0x83ea2b892091e44dULL, 0x934aed0aab460432ULL},
+    {0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL},
+    {0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL},
+    {0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL},
+    {0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL},
+    {0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL},
+    {0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL},
+    {0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL},
+    {0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL},
+    {0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL},
+    {0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL},
+    {0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL},
+    {0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL},
+    {0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL},
+    {0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL},
+    {0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL},
+    {0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL},
+    {0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL},
+    {0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL},
+    {0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL},
+    {0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL},
+    {0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL},
+    {0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL},
+    {0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL},
+    {0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL},
+    {0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL},
+    {0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL},
+    {0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL},
+    {0x8533285c936b35deULL, 0xd53a88958f87275fULL},
+    {0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL},
+    {0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL},
+    {0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL},
+    {0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL},
+    {0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL},
+    {0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL},
+    {0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL},
+    {0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL},
+    {0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL},
+    {0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL},
+    {0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL},
+    {0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL},
+    {0x976e41088617ca01ULL, 0xd5be0503e085d813ULL},
+    {0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL},
+    {0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL},
+    {0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL},
+    {0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL},
+    {0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL},
+    {0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL},
+    {0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL},
+    {0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL},
+    {0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL},
+    {0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL},
+    {0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL},
+    {0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL},
+    {0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL},
+    {0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL},
+    {0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL},
+    {0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL},
+    {0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL},
+    {0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL},
+    {0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL},
+    {0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL},
+    {0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL},
+    {0xa0555e361951c366ULL, 0xd7e105bcc332621fULL},
+    {0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL},
+    {0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL},
+    {0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL},
+    {0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL},
+    {0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL},
+    {0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL},
+    {0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL},
+    {0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL},
+    {0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL},
+    {0xbaa718e68396cffdULL, 0xd30560258f54e6baULL},
+    {0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL},
+    {0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL},
+    {0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL},
+    {0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL},
+    {0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL},
+};
 
-    // And free the node itself.
-    free(node);
-    node = NULL;
+// Powers of ten that are exactly representable as doubles.
+static const double jsn_exact_powers_of_ten[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/**
+ * Multiplies two 64 bit integers into a 128 bit result.
+ */
+static inline void jsn_multiply_64(uint64_t a, uint64_t b, uint64_t *high,
+                                   uint64_t *low) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 product = (unsigned __int128)a * b;
+    *high = (uint64_t)(product >> 64);
+    *low = (uint64_t)product;
+#else
+    uint64_t a_low = (uint32_t)a, a_high = a >> 32;
+    uint64_t b_low = (uint32_t)b, b_high = b >> 32;
+    uint64_t low_low = a_low * b_low;
+    uint64_t high_low = a_high * b_low;
+    uint64_t low_high = a_low * b_high;
+    uint64_t middle = (low_low >> 32) + (uint32_t)high_low + low_high;
+    *high = a_high * b_high + (high_low >> 32) + (middle >> 32);
+    *low = (middle << 32) | (uint32_t)low_low;
+#endif
 }
 
-struct jsn_node *jsn_get_node_direct_child(jsn_handle handle, const char *key) {
-    // If a null node is given, just return.
-    if (handle == NULL) {
-        return NULL;
+/**
+ * Converts mantissa * 10^exp10 into the closest double, using the Eisel-Lemire
+ * algorithm. Returns false if the result can't be decided.
+ */
+bool jsn_eisel_lemire(uint64_t mantissa, int exp10, bool negative,
+                      double *result) {
+    if (exp10 < JSN_POWERS_OF_TEN_MIN_EXP10 ||
+        exp10 > JSN_POWERS_OF_TEN_MAX_EXP10) {
+        return false;
     }
 
-    // Can optimize this to only check nodes with keys.
-    for (unsigned int i = 0; i < handle->children_count; i++) {
-        if (handle->children[i]->key != NULL) {
-            if (strcmp(handle->children[i]->key, key) == 0) {
-                return handle->children[i];
-            }
+    // Normalize the mantissa, so it's most significant bit is set.
+    int leading_zeros = __builtin_clzll(mantissa);
+    mantissa <<= leading_zeros;
+    uint64_t exp2 = (uint64_t)(((217706 * exp10) >> 16) + 64 + 1023) -
+                    (uint64_t)leading_zeros;
+
+    const uint64_t *power =
+        jsn_powers_of_ten[exp10 - JSN_POWERS_OF_TEN_MIN_EXP10];
+    uint64_t high, low;
+    jsn_multiply_64(mantissa, power[0], &high, &low);
+
+    // When the truncated bits could change the result, include the low 64
+    // bits of the power of ten as well.
+    if ((high & 0x1FF) == 0x1FF && low + mantissa < mantissa) {
+        uint64_t wide_high, wide_low;
+        jsn_multiply_64(mantissa, power[1], &wide_high, &wide_low);
+
+        uint64_t merged_high = high;
+        uint64_t merged_low = low + wide_high;
+        if (merged_low < low) {
+            merged_high++;
+        }
+
+        if ((merged_high & 0x1FF) == 0x1FF && merged_low + 1 == 0 &&
+            wide_low + mantissa < mantissa) {
+            return false;
         }
+
+        high = merged_high;
+        low = merged_low;
+    }
+
+    // Shift down to 54 bits.
+    uint64_t msb = high >> 63;
+    uint64_t bits = high >> (msb + 9);
+    exp2 -= 1 ^ msb;
+
+    // Exactly half way between two doubles, can't decide.
+    if (low == 0 && (high & 0x1FF) == 0 && (bits & 3) == 1) {
+        return false;
+    }
+
+    // Round from 54 down to 53 bits.
+    bits += bits & 1;
+    bits >>= 1;
+    if ((bits >> 53) > 0) {
+        bits >>= 1;
+        exp2 += 1;
+    }
+
+    // Subnormals, infinities and NaNs are left to the slow path.
+    if (exp2 - 1 >= 0x7FF - 1) {
+        return false;
+    }
+
+    bits = (exp2 << 52) | (bits & 0x000FFFFFFFFFFFFF);
+    if (negative) {
+        bits |= 0x8000000000000000;
     }
 
-    return NULL;
+    memcpy(result, &bits, sizeof(double));
+
+    return true;
 }
 
-int jsn_get_node_direct_child_index(jsn_handle handle, const char *key) {
-    for (unsigned int i = 0; i < handle->children_count; i++) {
-        if (handle->children[i]->key != NULL) {
-            if (strcmp(handle->children[i]->key, key) == 0) {
-                return i;
+/**
+ * Converts the number lexeme into a double. Only falls back to strtod (on a
+ * copy of the lexeme) for numbers that the fast paths can't round correctly.
+ */
+double jsn_parse_number_span(const char *start, unsigned int length) {
+    const char *cursor = start;
+    const char *end = start + length;
+
+    bool negative = cursor != end && *cursor == '-';
+    if (negative) {
+        cursor++;
+    }
+
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int exp10 = 0;
+    bool truncated = false;
+
+    // Integer part.
+    while (cursor != end && *cursor >= '0' && *cursor <= '9') {
+        if (mantissa != 0 || *cursor != '0') {
+            if (significant_digits < JSN_MAX_SIGNIFICANT_DIGITS) {
+                mantissa = mantissa * 10 + (*cursor - '0');
+                significant_digits++;
+            } else {
+                truncated = true;
             }
         }
+        cursor++;
     }
 
-    return -1;
-}
-
-void jsn_node_to_stream(jsn_handle handle, FILE *stream) {
-    if (handle->key != NULL) {
-        fprintf(stream, "\"%s\":", handle->key);
+    // Fraction part, each digit lowers the exponent.
+    if (cursor != end && *cursor == '.') {
+        cursor++;
+        while (cursor != end && *cursor >= '0' && *cursor <= '9') {
+            if (mantissa != 0 || *cursor != '0') {
+                if (significant_digits < JSN_MAX_SIGNIFICANT_DIGITS) {
+                    mantissa = mantissa * 10 + (*cursor - '0');
+                    significant_digits++;
+                } else {
+                    truncated = true;
+                }
+            }
+            exp10--;
+            cursor++;
+        }
     }
 
-    switch (handle->type) {
-    case JSN_NODE_STRING:
-        fprintf(stream, "\"%s\"", handle->value.value_string);
-        break;
-    case JSN_NODE_INTEGER:
-        fprintf(stream, "%u", handle->value.value_integer);
-        break;
-    case JSN_NODE_DOUBLE:
-        fprintf(stream, "%f", handle->value.value_double);
-        break;
-    case JSN_NODE_BOOLEAN: {
-        if (handle->value.value_boolean == true) {
-            fprintf(stream, "true");
-        } else {
-            fprintf(stream, "false");
+    // Exponent part.
+    if (cursor != end && (*cursor == 'e' || *cursor == 'E')) {
+        cursor++;
+
+        bool negative_exponent = false;
+        if (cursor != end && (*cursor == '-' || *cursor == '+')) {
+            negative_exponent = *cursor == '-';
+            cursor++;
         }
-    } break;
-    case JSN_NODE_NULL:
-        fprintf(stream, "null");
-        break;
-    case JSN_NODE_ARRAY: {
-        fprintf(stream, "[");
-        for (unsigned int i = 0; i < handle->children_count; i++) {
-            jsn_node_to_stream(handle->children[i], stream);
-            if (i != (handle->children_count - 1)) {
-                fprintf(stream, ",");
+
+        int exponent = 0;
+        while (cursor != end && *cursor >= '0' && *cursor <= '9') {
+            // Anything this large is zero or infinity anyway.
+            if (exponent < 100000) {
+                exponent = exponent * 10 + (*cursor - '0');
             }
+            cursor++;
         }
-        fprintf(stream, "]");
-    } break;
-    case JSN_NODE_OBJECT: {
-        fprintf(stream, "{");
-        for (unsigned int i = 0; i < handle->children_count; i++) {
-            jsn_node_to_stream(handle->children[i], stream);
-            if (i != (handle->children_count - 1)) {
-                fprintf(stream, ",");
+
+        exp10 += negative_exponent ? -exponent : exponent;
+    }
+
+    // Fast paths, only for well formed lexemes without dropped digits.
+    if (cursor == end && !truncated) {
+        if (mantissa == 0) {
+            return negative ? -0.0 : 0.0;
+        }
+
+        // Clinger's fast path, both the mantissa and the power of ten are
+        // exact doubles, so a single operation rounds correctly.
+        if (mantissa <= ((uint64_t)1 << 53) && exp10 >= -22 && exp10 <= 22) {
+            double value = (double)mantissa;
+            if (exp10 < 0) {
+                value /= jsn_exact_powers_of_ten[-exp10];
+            } else {
+                value *= jsn_exact_powers_of_ten[exp10];
             }
+            return negative ? -value : value;
+        }
+
+        double value;
+        if (jsn_eisel_lemire(mantissa, exp10, negative, &value)) {
+            return value;
         }
-        fprintf(stream, "}");
-    } break;
     }
-}
 
-/* PARSER:
- * --------------------------------------------------------------------------*/
+    // Slow path.
+    char lexeme[length + 1];
+    memcpy(lexeme, start, length);
+    lexeme[length] = '\0';
 
-struct jsn_node *jsn_parse_value(struct jsn_tokenizer *tokenizer,
-                                 struct jsn_token token);
+    return strtod(lexeme, NULL);
+}
 
-struct jsn_node *jsn_parse_string(struct jsn_tokenizer *tokenizer,
-                                  struct jsn_token token) {
-    struct jsn_node *node = jsn_create_node(JSN_NODE_STRING);
+/**
+ * Converts the integer lexeme into an int, wrapping around like atoi does for
+ * values that don't fit.
+ */
+int jsn_parse_integer_span(const char *start, unsigned int length) {
+    const char *cursor = start;
+    const char *end = start + length;
 
-    // Allocate string space.
-    char *str = malloc(token.lexeme_length + 1);
+    bool negative = cursor != end && *cursor == '-';
+    if (negative) {
+        cursor++;
+    }
 
-    // Check allocation success.
-    if (str == NULL) {
-        jsn_report_failure("Memory allocation failure.");
-        return NULL;
+    uint64_t value = 0;
+    while (cursor != end && *cursor >= '0' && *cursor <= '9') {
+        value = value * 10 + (*cursor - '0');
+        cursor++;
     }
 
-    // Copy over the token string.
-    node->value.value_string =
-        strncpy(str, token.lexeme_start, token.lexeme_length);
-    node->value.value_string[token.lexeme_length] = '\0';
+    return (int)(negative ? 0 - value : value);
+}
 
-    return node;
+/*
+ * Doubles are formatted with the Grisu2 algorithm, which produces the
+ * shortest digits that read back to the same double in almost all cases, and
+ * always digits that do. Integers are formatted two digits at a time.
+ */
+
+// Normalized 64 bit approximations (rounded) of 10^k, for k from -348 up to
+// and including 340 in steps of 8, with their binary exponents.
+static const struct {
+    uint64_t significand;
+    int exponent;
+} jsn_cached_powers[] = {
+    {0xfa8fd5a0081c0288ULL, -1220},
+    {0xbaaee17fa23ebf76ULL, -1193},
+    {0x8b16fb203055ac76ULL, -1166},
+    {0xcf42894a5dce35eaULL, -1140},
+    {0x9a6bb0aa55653b2dULL, -1113},
+    {0xe61acf033d1a45dfULL, -1087},
+    {0xab70fe17c79ac6caULL, -1060},
+    {0xff77b1fcbebcdc4fULL, -1034},
+    {0xbe5691ef416bd60cULL, -1007},
+    {0x8dd01fad907ffc3cULL, -980},
+    {0xd3515c2831559a83ULL, -954},
+    {0x9d71ac8fada6c9b5ULL, -927},
+    {0xea9c227723ee8bcbULL, -901},
+    {0xaecc49914078536dULL, -874},
+    {0x823c12795db6ce57ULL, -847},
+    {0xc21094364dfb5637ULL, -821},
+    {0x9096ea6f3848984fULL, -794},
+    {0xd77485cb25823ac7ULL, -768},
+    {0xa086cfcd97bf97f4ULL, -741},
+    {0xef340a98172aace5ULL, -715},
+    {0xb23867fb2a35b28eULL, -688},
+    {0x84c8d4dfd2c63f3bULL, -661},
+    {0xc5dd44271ad3cdbaULL, -635},
+    {0x936b9fcebb25c996ULL, -608},
+    {0xdbac6c247d62a584ULL, -582},
+    {0xa3ab66580d5fdaf6ULL, -555},
+    {0xf3e2f893dec3f126ULL, -529},
+    {0xb5b5ada8aaff80b8ULL, -502},
+    {0x87625f056c7c4a8bULL, -475},
+    {0xc9bcff6034c13053ULL, -449},
+    {0x964e858c91ba2655ULL, -422},
+    {0xdff9772470297ebdULL, -396},
+    {0xa6dfbd9fb8e5b88fULL, -369},
+    {0xf8a95fcf88747d94ULL, -343},
+    {0xb94470938fa89bcfULL, -316},
+    {0x8a08f0f8bf0f156bULL, -289},
+    {0xcdb02555653131b6ULL, -263},
+    {0x993fe2c6d07b7facULL, -236},
+    {0xe45c10c42a2b3b06ULL, -210},
+    {0xaa242499697392d3ULL, -183},
+    {0xfd87b5f28300ca0eULL, -157},
+    {0xbce5086492111aebULL, -130},
+    {0x8cbccc096f5088ccULL, -103},
+    {0xd1b71758e219652cULL, -77},
+    {0x9c40000000000000ULL, -50},
+    {0xe8d4a51000000000ULL, -24},
+    {0xad78ebc5ac620000ULL, 3},
+    {0x813f3978f8940984ULL, 30},
+    {0xc097ce7bc90715b3ULL, 56},
+    {0x8f7e32ce7bea5c70ULL, 83},
+    {0xd5d238a4abe98068ULL, 109},
+    {0x9f4f2726179a2245ULL, 136},
+    {0xed63a231d4c4fb27ULL, 162},
+    {0xb0de65388cc8ada8ULL, 189},
+    {0x83c7088e1aab65dbULL, 216},
+    {0xc45d1df942711d9aULL, 242},
+    {0x924d692ca61be758ULL, 269},
+    {0xda01ee641a708deaULL, 295},
+    {0xa26da3999aef774aULL, 322},
+    {0xf209787bb47d6b85ULL, 348},
+    {0xb454e4a179dd1877ULL, 375},
+    {0x865b86925b9bc5c2ULL, 402},
+    {0xc83553c5c8965d3dULL, 428},
+    {0x952ab45cfa97a0b3ULL, 455},
+    {0xde469fbd99a05fe3ULL, 481},
+    {0xa59bc234db398c25ULL, 508},
+    {0xf6c69a72a3989f5cULL, 534},
+    {0xb7dcbf5354e9beceULL, 561},
+    {0x88fcf317f22241e2ULL, 588},
+    {0xcc20ce9bd35c78a5ULL, 614},
+    {0x98165af37b2153dfULL, 641},
+    {0xe2a0b5dc971f303aULL, 667},
+    {0xa8d9d1535ce3b396ULL, 694},
+    {0xfb9b7cd9a4a7443cULL, 720},
+    {0xbb764c4ca7a44410ULL, 747},
+    {0x8bab8eefb6409c1aULL, 774},
+    {0xd01fef10a657842cULL, 800},
+    {0x9b10a4e5e9913129ULL, 827},
+    {0xe7109bfba19c0c9dULL, 853},
+    {0xac2820d9623bf429ULL, 880},
+    {0x80444b5e7aa7cf85ULL, 907},
+    {0xbf21e44003acdd2dULL, 933},
+    {0x8e679c2f5e44ff8fULL, 960},
+    {0xd433179d9c8cb841ULL, 986},
+    {0x9e19db92b4e31ba9ULL, 1013},
+    {0xeb96bf6ebadf77d9ULL, 1039},
+    {0xaf87023b9bf0ee6bULL, 1066},
+};
+
+static const uint64_t jsn_powers_of_ten_64[] = {1ULL,
+                                                10ULL,
+                                                100ULL,
+                                                1000ULL,
+                                                10000ULL,
+                                                100000ULL,
+                                                1000000ULL,
+                                                10000000ULL,
+                                                100000000ULL,
+                                                1000000000ULL,
+                                                10000000000ULL,
+                                                100000000000ULL,
+                                                1000000000000ULL,
+                                                10000000000000ULL,
+                                                100000000000000ULL,
+                                                1000000000000000ULL,
+                                                10000000000000000ULL,
+                                                100000000000000000ULL,
+                                                1000000000000000000ULL,
+                                                10000000000000000000ULL};
+
+static const char jsn_digit_pairs[] = "00010203040506070809"
+                                      "10111213141516171819"
+                                      "20212223242526272829"
+                                      "30313233343536373839"
+                                      "40414243444546474849"
+                                      "50515253545556575859"
+                                      "60616263646566676869"
+                                      "70717273747576777879"
+                                      "80818283848586878889"
+                                      "90919293949596979899";
+
+/**
+ * A floating point number with a 64 bit significand, significand * 2^exponent.
+ */
+struct jsn_diy_fp {
+    uint64_t significand;
+    int exponent;
+};
+
+static inline struct jsn_diy_fp jsn_diy_fp_multiply(struct jsn_diy_fp a,
+                                                    struct jsn_diy_fp b) {
+    uint64_t high, low;
+    jsn_multiply_64(a.significand, b.significand, &high, &low);
+
+    // Round the dropped low half.
+    struct jsn_diy_fp product = {high + (low >> 63),
+                                 a.exponent + b.exponent + 64};
+    return product;
 }
 
-struct jsn_node *jsn_parse_null(struct jsn_tokenizer *tokenizer,
-                                struct jsn_token token) {
-    struct jsn_node *node = jsn_create_node(JSN_NODE_NULL);
-    return node;
+static inline struct jsn_diy_fp jsn_diy_fp_normalize(struct jsn_diy_fp value) {
+    int shift = __builtin_clzll(value.significand);
+    value.significand <<= shift;
+    value.exponent -= shift;
+    return value;
 }
 
-struct jsn_node *jsn_parse_integer(struct jsn_tokenizer *tokenizer,
-                                   struct jsn_token token) {
-    struct jsn_node *node;
+/**
+ * Adjusts the last digit down, towards the exact value, as long as the digits
+ * stay within the rounding boundaries.
+ */
+static inline void jsn_grisu_round(char *digits, int length, uint64_t delta,
+                                   uint64_t rest, uint64_t ten_kappa,
+                                   uint64_t distance) {
+    while (rest < distance && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < distance ||
+            distance - rest > rest + ten_kappa - distance)) {
+        digits[length - 1]--;
+        rest += ten_kappa;
+    }
+}
 
-    // Check if the lexeme is a double.
-    char lexeme[token.lexeme_length + 1];
-    strncpy(lexeme, token.lexeme_start, token.lexeme_length);
-    lexeme[token.lexeme_length] = '\0';
+/**
+ * Generates the shortest digits of the scaled value within it's boundaries.
+ */
+void jsn_grisu_digits(struct jsn_diy_fp value, struct jsn_diy_fp upper,
+                      uint64_t delta, char *digits, int *length, int *exp10) {
+    const int shift = -upper.exponent;
+    const uint64_t one = (uint64_t)1 << shift;
+    const uint64_t distance = upper.significand - value.significand;
+
+    uint32_t integral = (uint32_t)(upper.significand >> shift);
+    uint64_t fraction = upper.significand & (one - 1);
+
+    int kappa = 1;
+    while (kappa < 10 && integral >= jsn_powers_of_ten_64[kappa]) {
+        kappa++;
+    }
 
-    // Integer
-    node = jsn_create_node(JSN_NODE_INTEGER);
-    node->value.value_integer = atoi(lexeme);
+    *length = 0;
 
-    return node;
+    // Digits of the integral part.
+    while (kappa > 0) {
+        uint32_t power = (uint32_t)jsn_powers_of_ten_64[kappa - 1];
+        uint32_t digit = integral / power;
+        integral %= power;
+
+        if (digit != 0 || *length != 0) {
+            digits[(*length)++] = '0' + digit;
+        }
+        kappa--;
+
+        uint64_t rest = ((uint64_t)integral << shift) + fraction;
+        if (rest <= delta) {
+            *exp10 += kappa;
+            jsn_grisu_round(digits, *length, delta, rest,
+                            jsn_powers_of_ten_64[kappa] << shift, distance);
+            return;
+        }
+    }
+
+    // Digits of the fractional part.
+    while (true) {
+        fraction *= 10;
+        delta *= 10;
+
+        char digit = (char)(fraction >> shift);
+        if (digit != 0 || *length != 0) {
+            digits[(*length)++] = '0' + digit;
+        }
+        fraction &= one - 1;
+        kappa--;
+
+        if (fraction < delta) {
+            *exp10 += kappa;
+            uint64_t scale = -kappa < 20 ? jsn_powers_of_ten_64[-kappa] : 0;
+            jsn_grisu_round(digits, *length, delta, fraction, one,
+                            distance * scale);
+            return;
+        }
+    }
 }
 
-struct jsn_node *jsn_parse_double(struct jsn_tokenizer *tokenizer,
-                                  struct jsn_token token) {
-    struct jsn_node *node;
+/**
+ * Produces the digits of a positive, finite double, the double equals
+ * digits * 10^exp10.
+ */
+void jsn_grisu2(double number, char *digits, int *length, int *exp10) {
+    uint64_t bits;
+    memcpy(&bits, &number, sizeof(bits));
 
-    // Check if the lexeme is a double.
-    char lexeme[token.lexeme_length + 1];
-    strncpy(lexeme, token.lexeme_start, token.lexeme_length);
-    lexeme[token.lexeme_length] = '\0';
+    int biased_exponent = (int)((bits >> 52) & 0x7FF);
+    uint64_t fraction = bits & 0xFFFFFFFFFFFFFULL;
 
-    // Double
-    node = jsn_create_node(JSN_NODE_DOUBLE);
-    node->value.value_double = strtod(lexeme, NULL);
+    struct jsn_diy_fp value;
+    if (biased_exponent != 0) {
+        value.significand = fraction | ((uint64_t)1 << 52);
+        value.exponent = biased_exponent - 1075;
+    } else {
+        value.significand = fraction;
+        value.exponent = -1074;
+    }
 
-    return node;
+    // The boundaries halfway to the neighbouring doubles, the lower one is
+    // closer when the significand is a power of two.
+    struct jsn_diy_fp upper = {(value.significand << 1) + 1,
+                               value.exponent - 1};
+    upper = jsn_diy_fp_normalize(upper);
+
+    struct jsn_diy_fp lower;
+    if (value.significand == ((uint64_t)1 << 52)) {
+        lower.significand = (value.significand << 2) - 1;
+        lower.exponent = value.exponent - 2;
+    } else {
+        lower.significand = (value.significand << 1) - 1;
+        lower.exponent = value.exponent - 1;
+    }
+    lower.significand <<= lower.exponent - upper.exponent;
+    lower.exponent = upper.exponent;
+
+    // Pick the cached power that brings the upper boundary's exponent into
+    // the range of -59 to -32.
+    double estimate = (-61 - upper.exponent) * 0.30102999566398114 + 347;
+    int k = (int)estimate;
+    if (estimate - k > 0.0) {
+        k++;
+    }
+    unsigned int index = (unsigned int)((k >> 3) + 1);
+    *exp10 = -(-348 + (int)index * 8);
+
+    struct jsn_diy_fp power = {jsn_cached_powers[index].significand,
+                               jsn_cached_powers[index].exponent};
+
+    struct jsn_diy_fp scaled =
+        jsn_diy_fp_multiply(jsn_diy_fp_normalize(value), power);
+    struct jsn_diy_fp scaled_upper = jsn_diy_fp_multiply(upper, power);
+    struct jsn_diy_fp scaled_lower = jsn_diy_fp_multiply(lower, power);
+
+    // Stay on the safe side of the rounding errors.
+    scaled_lower.significand++;
+    scaled_upper.significand--;
+
+    jsn_grisu_digits(scaled, scaled_upper,
+                     scaled_upper.significand - scaled_lower.significand,
+                     digits, length, exp10);
 }
 
-struct jsn_node *jsn_parse_boolean(struct jsn_tokenizer *tokenizer,
-                                   struct jsn_token token) {
-    struct jsn_node *node;
-    node = jsn_create_node(JSN_NODE_BOOLEAN);
+/**
+ * Writes the double in it's shortest form, followed by a null terminator.
+ * There's always a fraction or an exponent, so that it reads back as a double.
+ * Returns the number of chars written, the output needs to fit 32 chars.
+ */
+int jsn_format_double(double number, char *output) {
+    char *start = output;
 
-    if (token.lexeme_start[0] == 't') {
-        node->value.value_boolean = true;
+    if (signbit(number)) {
+        *output++ = '-';
+        number = -number;
+    }
+
+    if (number == 0) {
+        memcpy(output, "0.0", 4);
+        return output + 3 - start;
+    }
+
+    int length, exp10;
+    jsn_grisu2(number, output, &length, &exp10);
+
+    // Position of the decimal point, relative to the first digit.
+    int point = length + exp10;
+
+    if (exp10 >= 0 && point <= 21) {
+        // 1234e7 -> 12340000000.0
+        memset(&output[length], '0', exp10);
+        memcpy(&output[point], ".0", 3);
+        return output + point + 2 - start;
+    }
+
+    if (point > 0 && point <= 21) {
+        // 1234e-2 -> 12.34
+        memmove(&output[point + 1], &output[point], length - point);
+        output[point] = '.';
+        output[length + 1] = '\0';
+        return output + length + 1 - start;
+    }
+
+    if (point > -6 && point <= 0) {
+        // 1234e-6 -> 0.001234
+        int offset = 2 - point;
+        memmove(&output[offset], output, length);
+        output[0] = '0';
+        output[1] = '.';
+        memset(&output[2], '0', offset - 2);
+        output[length + offset] = '\0';
+        return output + length + offset - start;
+    }
+
+    // 1234e30 -> 1.234e33
+    char *cursor = &output[1];
+    if (length > 1) {
+        memmove(&output[2], &output[1], length - 1);
+        output[1] = '.';
+        cursor = &output[length + 1];
+    }
+
+    *cursor++ = 'e';
+    int exponent = point - 1;
+    if (exponent < 0) {
+        *cursor++ = '-';
+        exponent = -exponent;
+    }
+
+    if (exponent >= 100) {
+        *cursor++ = '0' + exponent / 100;
+        exponent %= 100;
+        memcpy(cursor, &jsn_digit_pairs[exponent * 2], 2);
+        cursor += 2;
+    } else if (exponent >= 10) {
+        memcpy(cursor, &jsn_digit_pairs[exponent * 2], 2);
+        cursor += 2;
     } else {
-        node->value.value_boolean = false;
+        *cursor++ = '0' + exponent;
     }
-    return node;
+
+    *cursor = '\0';
+    return cursor - start;
+}
+
+/**
+ * Writes the integer's digits, without a null terminator. Returns the number
+ * of chars written, the output needs to fit 11 chars.
+ */
+int jsn_format_integer(int number, char *output) {
+    char *start = output;
+    uint32_t value = (uint32_t)number;
+
+    if (number < 0) {
+        *output++ = '-';
+        value = 0 - value;
+    }
+
+    // Write the digits backwards, two at a time.
+    char digits[10];
+    char *cursor = &digits[10];
+
+    while (value >= 100) {
+        cursor -= 2;
+        memcpy(cursor, &jsn_digit_pairs[(value % 100) * 2], 2);
+        value /= 100;
+    }
+
+    if (value >= 10) {
+        cursor -= 2;
+        memcpy(cursor, &jsn_digit_pairs[value * 2], 2);
+    } else {
+        *--cursor = '0' + value;
+    }
+
+    size_t count = &digits[10] - cursor;
+    memcpy(output, cursor, count);
+
+    return output + count - start;
+}
+
+/* TREE DATA STRUCTURE:
+ * --------------------------------------------------------------------------*/
+
+#define JSN_CHILDREN_MIN_CAPACITY 4
+
+// Objects with at least this many children get a hash index for their keys.
+// It's built as soon as their children are set, so that looking up keys never
+// changes the tree and can be done from multiple threads at once.
+#define JSN_KEY_INDEX_THRESHOLD 16
+
+// Bytes of a node that short keys and strings are stored in, instead of being
+// allocated separately. It's the size of the fields only arrays and objects
+// use, which it shares it's memory with.
+#define JSN_INLINE_CAPACITY 16
+
+enum jsn_node_type {
+    JSN_NODE_NULL,
+    JSN_NODE_INTEGER,
+    JSN_NODE_DOUBLE,
+    JSN_NODE_BOOLEAN,
+    JSN_NODE_STRING,
+    JSN_NODE_ARRAY,
+    JSN_NODE_OBJECT,
+};
+
+struct jsn_key_index_slot {
+    uint32_t hash;
+    // The child's index plus one, zero marks an empty slot.
+    uint32_t child;
+};
+
+/**
+ * Open addressing hash table, that maps an object's keys to the indexes of
+ * it's children.
+ */
+struct jsn_key_index {
+    unsigned int capacity;
+    unsigned int count;
+    struct jsn_key_index_slot slots[];
+};
+
+/**
+ * A key that's shared by the nodes of a parsed document. The key's characters
+ * directly follow the reference count.
+ */
+struct jsn_interned_key {
+    unsigned int references;
+    char key[];
+};
+
+static inline struct jsn_interned_key *jsn_interned_key_of(char *key) {
+    return (struct jsn_interned_key *)(key -
+                                       offsetof(struct jsn_interned_key, key));
+}
+
+union jsn_node_value {
+    int value_integer;
+    double value_double;
+    bool value_boolean;
+    char *value_string;
+};
+
+struct jsn_node {
+    char *key;
+    union jsn_node_value value;
+    union {
+        // Arrays and objects.
+        struct {
+            struct jsn_node **children;
+            // Hash index of the children's keys, only used by large objects.
+            struct jsn_key_index *key_index;
+        };
+        // Any other node's short key and string.
+        char inline_data[JSN_INLINE_CAPACITY];
+    };
+    // The arena the node and it's members were allocated from, or NULL.
+    struct jsn_arena *arena;
+    enum jsn_node_type type;
+    unsigned int children_count;
+    unsigned int children_capacity;
+    // The key is shared with other nodes, see jsn_interned_key.
+    bool key_interned;
+    // The node was added to another node of the same arena.
+    bool attached;
+    // The inline data used by the key (from the front) and by the string (from
+    // the back), including their null terminators.
+    unsigned char inline_key_length;
+    unsigned char inline_string_length;
+};
+
+struct jsn_node *jsn_create_node(struct jsn_arena *arena,
+                                 enum jsn_node_type type) {
+    // Let's allocate some memory on the heap (or arena).
+    struct jsn_node *node = jsn_alloc(arena, sizeof(struct jsn_node));
+
+    // Set some sane defaults.
+    node->key = NULL;
+    node->key_interned = false;
+    node->attached = false;
+    node->inline_key_length = 0;
+    node->inline_string_length = 0;
+    node->type = type;
+    node->children_count = 0;
+    node->children_capacity = 0;
+    node->children = NULL;
+    node->arena = arena;
+    node->key_index = NULL;
+
+    return node;
+}
+
+/**
+ * Stores a copy of the key inside of the node, if it fits next to the node's
+ * inline string. Returns false when it doesn't fit, or when the node is an
+ * array or object.
+ */
+static inline bool jsn_set_node_inline_key(struct jsn_node *node,
+                                           const char *key, size_t length) {
+    if (length + 1 + node->inline_string_length > JSN_INLINE_CAPACITY ||
+        node->type == JSN_NODE_ARRAY || node->type == JSN_NODE_OBJECT) {
+        return false;
+    }
+
+    memcpy(node->inline_data, key, length);
+    node->inline_data[length] = '\0';
+    node->inline_key_length = (unsigned char)(length + 1);
+    node->key = node->inline_data;
+
+    return true;
+}
+
+/**
+ * Sets the node's key to a copy of the given key, which is stored inside of
+ * the node when it's short enough.
+ */
+void jsn_set_node_key(struct jsn_node *node, const char *key, size_t length) {
+    if (!jsn_set_node_inline_key(node, key, length)) {
+        node->key = jsn_copy_string(node->arena, key, length);
+    }
+}
+
+/**
+ * Sets the node's string to a copy of the given string, which is stored
+ * inside of the node when it's short enough.
+ */
+void jsn_set_node_string(struct jsn_node *node, const char *string,
+                         size_t length) {
+    if (length + 1 + node->inline_key_length > JSN_INLINE_CAPACITY) {
+        node->value.value_string = jsn_copy_string(node->arena, string, length);
+        return;
+    }
+
+    char *inline_string = &node->inline_data[JSN_INLINE_CAPACITY - length - 1];
+    memcpy(inline_string, string, length);
+    inline_string[length] = '\0';
+    node->inline_string_length = (unsigned char)(length + 1);
+    node->value.value_string = inline_string;
+}
+
+/**
+ * Releases the node's key, interned keys are freed once no other node is using
+ * them anymore.
+ */
+void jsn_free_node_key(struct jsn_node *node) {
+    if (node->key == NULL) {
+        return;
+    }
+
+    if (node->inline_key_length != 0) {
+        node->inline_key_length = 0;
+    } else if (node->arena == NULL) {
+        if (node->key_interned == false) {
+            jsn_free_memory(node->key);
+        } else {
+            struct jsn_interned_key *interned = jsn_interned_key_of(node->key);
+            if (--interned->references == 0) {
+                jsn_free_memory(interned);
+            }
+        }
+    }
+
+    node->key = NULL;
+    node->key_interned = false;
+}
+
+/**
+ * Creates a node for the jsn_create_* functions. When in arena mode, the node
+ * is allocated from the document that's currently being built.
+ */
+struct jsn_node *jsn_create_builder_node(enum jsn_node_type type) {
+    if ((jsn_options & JSN_OPTION_ARENA) == 0) {
+        return jsn_create_node(NULL, type);
+    }
+
+    // Start a new document if needed.
+    if (jsn_builder_arena == NULL) {
+        jsn_builder_arena = jsn_arena_create();
+    }
+
+    return jsn_create_node(jsn_builder_arena, type);
+}
+
+/**
+ * FNV-1a hash of the given key.
+ */
+static inline uint32_t jsn_hash_key(const char *key, size_t length) {
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)key[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+void jsn_key_index_free(struct jsn_node *node) {
+    if (node->key_index != NULL && node->arena == NULL) {
+        jsn_free_memory(node->key_index);
+    }
+    node->key_index = NULL;
+}
+
+/**
+ * Adds the child at the given index to the node's key index. The first child
+ * with a given key wins, just like the linear lookup.
+ */
+void jsn_key_index_insert(struct jsn_node *node, unsigned int child_index) {
+    struct jsn_key_index *index = node->key_index;
+    const char *key = node->children[child_index]->key;
+
+    if (key == NULL) {
+        return;
+    }
+
+    uint32_t hash = jsn_hash_key(key, strlen(key));
+    unsigned int mask = index->capacity - 1;
+    unsigned int slot = hash & mask;
+
+    while (index->slots[slot].child != 0) {
+        struct jsn_key_index_slot *taken = &index->slots[slot];
+
+        const char *child_key = node->children[taken->child - 1]->key;
+
+        if (taken->hash == hash &&
+            (child_key == key || strcmp(child_key, key) == 0)) {
+            return;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    index->slots[slot].hash = hash;
+    index->slots[slot].child = child_index + 1;
+    index->count++;
+}
+
+/**
+ * (Re)builds the node's key index, sized for at least the given number of
+ * children.
+ */
+void jsn_key_index_build(struct jsn_node *node, unsigned int children) {
+    jsn_key_index_free(node);
+
+    // Keep the load factor at or below one half.
+    unsigned int capacity = JSN_KEY_INDEX_THRESHOLD * 2;
+    while (capacity < children * 2) {
+        capacity *= 2;
+    }
+
+    size_t size = sizeof(struct jsn_key_index) +
+                  sizeof(struct jsn_key_index_slot) * capacity;
+    node->key_index = jsn_alloc(node->arena, size);
+    memset(node->key_index, 0, size);
+    node->key_index->capacity = capacity;
+
+    for (unsigned int i = 0; i < node->children_count; i++) {
+        jsn_key_index_insert(node, i);
+    }
+}
+
+/**
+ * Builds the node's key index if it's an object that needs one, this is
+ * called once it's children are set.
+ */
+static inline void jsn_key_index_prepare(struct jsn_node *node) {
+    if (node->type == JSN_NODE_OBJECT && node->key_index == NULL &&
+        node->children_count >= JSN_KEY_INDEX_THRESHOLD) {
+        jsn_key_index_build(node, node->children_count);
+    }
+}
+
+/**
+ * Returns the index of the first child with the given key, or -1 when no such
+ * child exists.
+ */
+int jsn_key_index_find(struct jsn_node *node, const char *key, size_t length,
+                       uint32_t hash) {
+    struct jsn_key_index *index = node->key_index;
+    unsigned int mask = index->capacity - 1;
+    unsigned int slot = hash & mask;
+
+    while (index->slots[slot].child != 0) {
+        struct jsn_key_index_slot *taken = &index->slots[slot];
+        const char *child_key = node->children[taken->child - 1]->key;
+
+        // Interned keys can often be matched by their address alone.
+        if (taken->hash == hash &&
+            (child_key == key || strncmp(child_key, key, length) == 0) &&
+            child_key[length] == '\0') {
+            return taken->child - 1;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return -1;
+}
+
+/**
+ * Updates the arena bookkeeping for a child that's being added to the given
+ * parent.
+ */
+void jsn_adopt_node_child(struct jsn_node *parent, struct jsn_node *child) {
+    if (parent->arena == NULL) {
+        return;
+    }
+
+    // Keep track of heap nodes that get added to an arena document.
+    if (child->arena != parent->arena) {
+        parent->arena->foreign_count++;
+        return;
+    }
+
+    // The child is no longer the top of the document, so it won't release
+    // the arena.
+    child->attached = true;
+}
+
+void jsn_append_node_child(struct jsn_node *parent, struct jsn_node *child) {
+    jsn_adopt_node_child(parent, child);
+
+    unsigned int count = parent->children_count;
+
+    // Grow the children storage geometrically, so that appending stays
+    // linear in the number of children.
+    if (count == parent->children_capacity) {
+        unsigned int capacity =
+            count == 0 ? JSN_CHILDREN_MIN_CAPACITY : count * 2;
+        size_t size = sizeof(struct jsn_node *) * capacity;
+        JSN_STATS_ADD(children_reallocations, 1);
+
+        if (parent->arena == NULL) {
+            struct jsn_node **children = jsn_realloc(parent->children, size);
+
+            // Check allocation success.
+            if (children == NULL) {
+                jsn_report_failure("Memory allocation failure.");
+                return;
+            }
+
+            parent->children = children;
+        } else {
+            // Arena memory can't be reallocated, so move to a new array.
+            struct jsn_node **children = jsn_arena_alloc(parent->arena, size);
+            if (count != 0) {
+                memcpy(children, parent->children,
+                       sizeof(struct jsn_node *) * count);
+            }
+            parent->children = children;
+        }
+
+        parent->children_capacity = capacity;
+    }
+
+    // Set the new node and increment the children count.
+    parent->children[count] = child;
+    parent->children_count++;
+
+    // Keep the key index in sync, growing it when it gets too full.
+    if (parent->key_index != NULL) {
+        if ((parent->key_index->count + 1) * 2 > parent->key_index->capacity) {
+            jsn_key_index_build(parent, parent->children_count);
+        } else {
+            jsn_key_index_insert(parent, count);
+        }
+    } else {
+        jsn_key_index_prepare(parent);
+    }
+}
+
+/**
+ * Sets the node's children to an exact sized copy of the given nodes, this is
+ * used by the parser once all children of a node are known.
+ */
+void jsn_set_node_children(struct jsn_node *node, struct jsn_node **children,
+                           unsigned int count) {
+    if (count == 0) {
+        return;
+    }
+
+    size_t size = sizeof(struct jsn_node *) * count;
+    node->children = jsn_alloc(node->arena, size);
+    memcpy(node->children, children, size);
+    node->children_count = count;
+    node->children_capacity = count;
+    jsn_key_index_prepare(node);
+}
+
+void jsn_free_node(struct jsn_node *node);
+
+/**
+ * Frees a child node that is being removed from the given parent.
+ */
+void jsn_release_node_child(struct jsn_node *parent, struct jsn_node *child) {
+    if (parent->arena != NULL && child->arena != parent->arena) {
+        parent->arena->foreign_count--;
+    }
+
+    jsn_free_node(child);
+}
+
+void jsn_free_node_children(struct jsn_node *node) {
+    // When the node has no children.
+    if (node->children_count == 0) {
+        return;
+    }
+
+    // Free each child node, this will recursively free their children too.
+    for (unsigned int i = 0; i < node->children_count; i++) {
+        jsn_release_node_child(node, node->children[i]);
+    }
+
+    // Now we can free this parents data.
+    if (node->arena == NULL) {
+        jsn_free_memory(node->children);
+    }
+    jsn_key_index_free(node);
+    node->children = NULL;
+    node->children_count = 0;
+    node->children_capacity = 0;
+}
+
+void jsn_free_node_members(struct jsn_node *node, bool keep_key) {
+    // If it's a string, free it.
+    if (node->type == JSN_NODE_STRING) {
+        if (node->inline_string_length != 0) {
+            node->inline_string_length = 0;
+        } else if (node->arena == NULL) {
+            jsn_free_memory(node->value.value_string);
+        }
+        node->value.value_string = NULL;
+    }
+
+    // If it has a key we also need to free that.
+    if (keep_key == false) {
+        jsn_free_node_key(node);
+    }
+
+    // We also need to free it's children.
+    if (node->children_count != 0) {
+        jsn_free_node_children(node);
+    }
+}
+
+/**
+ * Makes room for the fields of an array or object, by moving an inline key
+ * into memory of it's own.
+ */
+void jsn_clear_node_inline_data(struct jsn_node *node) {
+    if (node->type == JSN_NODE_ARRAY || node->type == JSN_NODE_OBJECT) {
+        return;
+    }
+
+    if (node->inline_key_length != 0) {
+        node->key = jsn_copy_string(node->arena, node->inline_data,
+                                    node->inline_key_length - 1);
+        node->inline_key_length = 0;
+    }
+
+    node->children = NULL;
+    node->key_index = NULL;
+}
+
+void jsn_free_node(struct jsn_node *node) {
+    struct jsn_arena *arena = node->arena;
+
+    if (arena == NULL) {
+        // Free all it's members.
+        jsn_free_node_members(node, false);
+
+        // And free the node itself.
+        jsn_free_memory(node);
+        return;
+    }
+
+    // Arena memory is released along with the whole document, but any heap
+    // nodes that were appended to it still need to be freed one by one.
+    if (arena->foreign_count > 0) {
+        jsn_free_node_children(node);
+    }
+
+    if (arena->owner == node || (arena->owner == NULL && !node->attached)) {
+        jsn_arena_free(arena);
+    }
+}
+
+/**
+ * Returns the index of the child with the given key and key hash, or -1 when
+ * there is no such child. Large objects are looked up through their key index.
+ */
+int jsn_get_node_direct_child_index_hashed(jsn_handle handle, const char *key,
+                                           size_t length, uint32_t hash) {
+    if (handle->children_count >= JSN_KEY_INDEX_THRESHOLD &&
+        handle->type == JSN_NODE_OBJECT) {
+        return jsn_key_index_find(handle, key, length, hash);
+    }
+
+    // Small objects are just scanned.
+    for (unsigned int i = 0; i < handle->children_count; i++) {
+        const char *child_key = handle->children[i]->key;
+
+        if (child_key != NULL &&
+            (child_key == key || strncmp(child_key, key, length) == 0) &&
+            child_key[length] == '\0') {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+int jsn_get_node_direct_child_index(jsn_handle handle, const char *key) {
+    size_t length = strlen(key);
+
+    // Small objects don't need the key's hash.
+    uint32_t hash = 0;
+    if (handle->children_count >= JSN_KEY_INDEX_THRESHOLD) {
+        hash = jsn_hash_key(key, length);
+    }
+
+    return jsn_get_node_direct_child_index_hashed(handle, key, length, hash);
+}
+
+struct jsn_node *jsn_get_node_direct_child(jsn_handle handle, const char *key) {
+    // If a null node is given, just return.
+    if (handle == NULL) {
+        return NULL;
+    }
+
+    int index = jsn_get_node_direct_child_index(handle, key);
+    if (index == -1) {
+        return NULL;
+    }
+
+    return handle->children[index];
+}
+
+/* PATHS:
+ * --------------------------------------------------------------------------*/
+
+/**
+ * One step of a compiled path, either an object key or an array index. Keys
+ * point into the path's copy of the expression, and keep their length and
+ * hash so they are never measured or hashed again.
+ */
+struct jsn_path_segment {
+    // NULL for array indexes.
+    const char *key;
+    size_t length;
+    uint32_t hash;
+    unsigned int index;
+};
+
+struct jsn_path {
+    unsigned int count;
+    struct jsn_path_segment segments[];
+};
+
+/**
+ * Splits the given expression into segments, the segments are only counted
+ * when NULL is given. Returns the number of segments, or -1 when the
+ * expression is invalid.
+ */
+int jsn_path_scan(const char *expression, struct jsn_path_segment *segments) {
+    const char *cursor = expression;
+    int count = 0;
+
+    while (*cursor != '\0') {
+        struct jsn_path_segment segment = {NULL, 0, 0, 0};
+
+        if (*cursor == '[') {
+            // Array indexes, made out of at least one digit.
+            const char *digits = ++cursor;
+            while (*cursor >= '0' && *cursor <= '9') {
+                if (segment.index > (UINT_MAX - 9) / 10) {
+                    return -1;
+                }
+                segment.index = segment.index * 10 + (*cursor++ - '0');
+            }
+
+            if (cursor == digits || *cursor++ != ']') {
+                return -1;
+            }
+        } else {
+            // Keys after the first segment are preceded by a dot.
+            if (count > 0 && *cursor++ != '.') {
+                return -1;
+            }
+
+            segment.key = cursor;
+            while (*cursor != '\0' && *cursor != '.' && *cursor != '[') {
+                cursor++;
+            }
+
+            segment.length = cursor - segment.key;
+            if (segment.length == 0) {
+                return -1;
+            }
+            segment.hash = jsn_hash_key(segment.key, segment.length);
+        }
+
+        if (segments != NULL) {
+            segments[count] = segment;
+        }
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * Follows the given path from the given node, starting at the given segment.
+ * Returns NULL on the first key or index that's missing.
+ */
+struct jsn_node *jsn_path_follow(const struct jsn_path *path,
+                                 unsigned int first, struct jsn_node *node) {
+    for (unsigned int i = first; i < path->count && node != NULL; i++) {
+        const struct jsn_path_segment *segment = &path->segments[i];
+
+        if (segment->key == NULL) {
+            if (node->type != JSN_NODE_ARRAY ||
+                segment->index >= node->children_count) {
+                return NULL;
+            }
+
+            node = node->children[segment->index];
+            continue;
+        }
+
+        if (node->type != JSN_NODE_OBJECT) {
+            return NULL;
+        }
+
+        int index = jsn_get_node_direct_child_index_hashed(
+            node, segment->key, segment->length, segment->hash);
+        node = index == -1 ? NULL : node->children[index];
+    }
+
+    return node;
+}
+
+/* SERIALIZER:
+ * --------------------------------------------------------------------------*/
+
+// Writers that flush to a stream do so in blocks of about this size.
+#define JSN_WRITER_BLOCK_SIZE 65536
+
+/**
+ * Growable output buffer the JSON gets written into. When it has a stream,
+ * the buffer is flushed to it once full instead of growing further.
+ */
+struct jsn_writer {
+    char *data;
+    size_t length;
+    size_t capacity;
+    FILE *stream;
+    // Buffers that are returned to the caller use malloc, so that they can be
+    // released with free. Other buffers use the library's allocator.
+    bool returned;
+};
+
+struct jsn_writer jsn_writer_init(FILE *stream, bool returned) {
+    struct jsn_writer writer;
+    writer.capacity = JSN_WRITER_BLOCK_SIZE;
+    writer.length = 0;
+    writer.stream = stream;
+    writer.returned = returned;
+    writer.data =
+        returned ? malloc(writer.capacity) : jsn_malloc(writer.capacity);
+
+    // Check allocation success.
+    if (writer.data == NULL) {
+        jsn_report_failure("Memory allocation failure.");
+    }
+
+    return writer;
+}
+
+void jsn_writer_free(struct jsn_writer *writer) {
+    if (writer->returned) {
+        free(writer->data);
+    } else {
+        jsn_free_memory(writer->data);
+    }
+    writer->data = NULL;
+}
+
+void jsn_writer_flush(struct jsn_writer *writer) {
+    if (writer->length > 0) {
+        if (fwrite(writer->data, 1, writer->length, writer->stream) !=
+            writer->length) {
+            jsn_report_failure("The file could not be written.");
+        }
+        writer->length = 0;
+    }
+}
+
+/**
+ * Makes sure there's space for the given number of bytes.
+ */
+static inline void jsn_writer_reserve(struct jsn_writer *writer,
+                                      size_t size) {
+    if (writer->length + size <= writer->capacity) {
+        return;
+    }
+
+    if (writer->stream != NULL) {
+        jsn_writer_flush(writer);
+    }
+
+    while (writer->length + size > writer->capacity) {
+        writer->capacity *= 2;
+    }
+
+    writer->data = writer->returned
+                       ? realloc(writer->data, writer->capacity)
+                       : jsn_realloc(writer->data, writer->capacity);
+
+    // Check allocation success.
+    if (writer->data == NULL) {
+        jsn_report_failure("Memory allocation failure.");
+    }
+}
+
+static inline void jsn_writer_put(struct jsn_writer *writer, const char *data,
+                                  size_t length) {
+    jsn_writer_reserve(writer, length);
+    memcpy(&writer->data[writer->length], data, length);
+    writer->length += length;
+}
+
+static inline void jsn_writer_put_char(struct jsn_writer *writer, char c) {
+    jsn_writer_reserve(writer, 1);
+    writer->data[writer->length++] = c;
+}
+
+static inline void jsn_writer_put_integer(struct jsn_writer *writer,
+                                          int value) {
+    jsn_writer_reserve(writer, 11);
+    writer->length += jsn_format_integer(value, &writer->data[writer->length]);
+}
+
+static inline void jsn_writer_put_double(struct jsn_writer *writer,
+                                         double value) {
+    // JSON has no representation for infinities and NaN.
+    if (isfinite(value) == false) {
+        jsn_writer_put(writer, "null", 4);
+        return;
+    }
+
+    jsn_writer_reserve(writer, 32);
+    writer->length += jsn_format_double(value, &writer->data[writer->length]);
+}
+
+/**
+ * Writes the string surrounded by quotes, followed by the given suffix.
+ */
+static inline void jsn_writer_put_quoted(struct jsn_writer *writer,
+                                         const char *string,
+                                         const char *suffix,
+                                         size_t suffix_length) {
+    size_t length = strlen(string);
+    jsn_writer_reserve(writer, length + 2 + suffix_length);
+
+    char *output = &writer->data[writer->length];
+    output[0] = '"';
+    memcpy(&output[1], string, length);
+    output[length + 1] = '"';
+    memcpy(&output[length + 2], suffix, suffix_length);
+    writer->length += length + 2 + suffix_length;
+}
+
+/**
+ * Writes the JSON of the given node, including it's key.
+ */
+void jsn_write_node(struct jsn_writer *writer, jsn_handle handle) {
+    if (handle->key != NULL) {
+        jsn_writer_put_quoted(writer, handle->key, ":", 1);
+    }
+
+    switch (handle->type) {
+    case JSN_NODE_STRING:
+        jsn_writer_put_quoted(writer, handle->value.value_string, "", 0);
+        break;
+    case JSN_NODE_INTEGER:
+        jsn_writer_put_integer(writer, handle->value.value_integer);
+        break;
+    case JSN_NODE_DOUBLE:
+        jsn_writer_put_double(writer, handle->value.value_double);
+        break;
+    case JSN_NODE_BOOLEAN: {
+        if (handle->value.value_boolean == true) {
+            jsn_writer_put(writer, "true", 4);
+        } else {
+            jsn_writer_put(writer, "false", 5);
+        }
+    } break;
+    case JSN_NODE_NULL:
+        jsn_writer_put(writer, "null", 4);
+        break;
+    case JSN_NODE_ARRAY:
+    case JSN_NODE_OBJECT: {
+        jsn_writer_put_char(writer, handle->type == JSN_NODE_ARRAY ? '[' : '{');
+        for (unsigned int i = 0; i < handle->children_count; i++) {
+            if (i != 0) {
+                jsn_writer_put_char(writer, ',');
+            }
+            jsn_write_node(writer, handle->children[i]);
+        }
+        jsn_writer_put_char(writer, handle->type == JSN_NODE_ARRAY ? ']' : '}');
+    } break;
+    }
+}
+
+/**
+ * Writes the JSON of the given node to the stream, in large blocks.
+ */
+void jsn_node_to_stream(jsn_handle handle, FILE *stream) {
+    struct jsn_writer writer = jsn_writer_init(stream, false);
+    jsn_write_node(&writer, handle);
+    jsn_writer_flush(&writer);
+    jsn_writer_free(&writer);
+}
+
+/* PARSER:
+ * --------------------------------------------------------------------------*/
+
+#define JSN_PARSE_STACK_MIN_CAPACITY 64
+
+struct jsn_key_table_slot {
+    uint32_t hash;
+    unsigned int length;
+    char *key;
+};
+
+/**
+ * Open addressing hash table of the keys seen while parsing a document.
+ */
+struct jsn_key_table {
+    struct jsn_key_table_slot *slots;
+    unsigned int capacity;
+    unsigned int count;
+};
+
+struct jsn_parse_context {
+    struct jsn_tokenizer tokenizer;
+    // The arena of the document being parsed, NULL when not in arena mode.
+    struct jsn_arena *arena;
+    // Scratch stack that collects the children of the arrays and objects
+    // that are currently being parsed.
+    struct jsn_node **stack;
+    unsigned int stack_count;
+    unsigned int stack_capacity;
+    // When parsing in two stages, tokens are read from the structural index.
+    bool indexed;
+    struct jsn_structural_index index;
+    // Keys seen so far, so that repeated keys are only stored once.
+    struct jsn_key_table keys;
+    // Strings and keys point into the (patched) source instead of being
+    // copied, the document's nodes are always allocated from an arena.
+    bool insitu;
+};
+
+/**
+ * Initializes a context that only reads tokens and doesn't create any nodes.
+ */
+void jsn_parse_context_init_tokens(struct jsn_parse_context *context,
+                                   char *source, size_t source_length) {
+    context->keys.slots = NULL;
+    context->keys.capacity = 0;
+    context->keys.count = 0;
+
+    context->tokenizer = jsn_tokenizer_init(source, source_length, false);
+    context->arena = NULL;
+    context->insitu = false;
+
+    context->stack = NULL;
+    context->stack_count = 0;
+    context->stack_capacity = 0;
+
+    // Build the structural index up front (stage 1). It's positions are 32
+    // bit, larger sources are parsed in a single stage.
+    context->indexed = (jsn_options & JSN_OPTION_STRUCTURAL_INDEX) != 0 &&
+                       source_length <= UINT32_MAX;
+    if (context->indexed) {
+        jsn_structural_index_build(&context->index, source, source_length);
+    }
+}
+
+void jsn_parse_context_init(struct jsn_parse_context *context, char *source,
+                            size_t source_length, bool insitu) {
+    jsn_parse_context_init_tokens(context, source, source_length);
+
+    // In arena mode, each document get's it's own arena.
+    if ((jsn_options & JSN_OPTION_ARENA) || insitu) {
+        context->arena = jsn_arena_create();
+    }
+    context->insitu = insitu;
+}
+
+void jsn_parse_context_free(struct jsn_parse_context *context) {
+    jsn_free_memory(context->stack);
+    context->stack = NULL;
+    context->stack_count = 0;
+    context->stack_capacity = 0;
+
+    if (context->indexed) {
+        jsn_structural_index_free(&context->index);
+    }
+
+    jsn_free_memory(context->keys.slots);
+    context->keys.slots = NULL;
+    context->keys.capacity = 0;
+    context->keys.count = 0;
+}
+
+/**
+ * Sets the node's key to the interned copy of the given key, the copy is
+ * created the first time a key is seen. Short keys are copied into the node
+ * instead, which is cheaper than looking them up.
+ */
+void jsn_parse_intern_key(struct jsn_parse_context *context,
+                          struct jsn_node *node, const char *key,
+                          unsigned int length) {
+    if (jsn_set_node_inline_key(node, key, length)) {
+        JSN_STATS_ADD(keys_copied, 1);
+        return;
+    }
+
+    struct jsn_key_table *table = &context->keys;
+
+    // Grow the table, keeping the load factor at or below one half.
+    if ((table->count + 1) * 2 > table->capacity) {
+        unsigned int capacity = table->capacity == 0 ? 64 : table->capacity * 2;
+        struct jsn_key_table_slot *slots =
+            jsn_calloc(capacity, sizeof(struct jsn_key_table_slot));
+        if (slots == NULL) {
+            jsn_report_failure("Memory allocation failure.");
+        }
+
+        for (unsigned int i = 0; i < table->capacity; i++) {
+            if (table->slots[i].key != NULL) {
+                unsigned int slot = table->slots[i].hash & (capacity - 1);
+                while (slots[slot].key != NULL) {
+                    slot = (slot + 1) & (capacity - 1);
+                }
+                slots[slot] = table->slots[i];
+            }
+        }
+
+        jsn_free_memory(table->slots);
+        table->slots = slots;
+        table->capacity = capacity;
+    }
+
+    uint32_t hash = jsn_hash_key(key, length);
+    unsigned int mask = table->capacity - 1;
+    unsigned int slot = hash & mask;
+
+    while (table->slots[slot].key != NULL) {
+        struct jsn_key_table_slot *taken = &table->slots[slot];
+
+        if (taken->hash == hash && taken->length == length &&
+            memcmp(taken->key, key, length) == 0) {
+            break;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    struct jsn_key_table_slot *entry = &table->slots[slot];
+
+    // First time we see this key, create the shared copy.
+    if (entry->key == NULL) {
+        entry->hash = hash;
+        entry->length = length;
+        table->count++;
+        JSN_STATS_ADD(keys_copied, 1);
+
+        if (context->arena != NULL) {
+            // Arena keys live as long as the document, no counting needed.
+            entry->key = jsn_copy_string(context->arena, key, length);
+        } else {
+            struct jsn_interned_key *interned =
+                jsn_malloc(sizeof(struct jsn_interned_key) + length + 1);
+            if (interned == NULL) {
+                jsn_report_failure("Memory allocation failure.");
+            }
+            interned->references = 0;
+            memcpy(interned->key, key, length);
+            interned->key[length] = '\0';
+            entry->key = interned->key;
+        }
+    }
+
+    if (context->arena == NULL) {
+        jsn_interned_key_of(entry->key)->references++;
+        node->key_interned = true;
+    }
+
+    node->key = entry->key;
+}
+
+/**
+ * Returns the next token, either from the tokenizer or from the structural
+ * index when parsing in two stages.
+ */
+static inline struct jsn_token
+jsn_parse_next_token(struct jsn_parse_context *context) {
+    if (context->indexed) {
+        return jsn_tokenizer_get_indexed_token(&context->tokenizer,
+                                               &context->index);
+    }
+
+    return jsn_tokenizer_get_next_token(&context->tokenizer);
+}
+
+/**
+ * Pushes a parsed child node onto the scratch stack.
+ */
+void jsn_parse_stack_push(struct jsn_parse_context *context,
+                          struct jsn_node *node) {
+    if (context->stack_count == context->stack_capacity) {
+        unsigned int capacity = context->stack_capacity == 0
+                                    ? JSN_PARSE_STACK_MIN_CAPACITY
+                                    : context->stack_capacity * 2;
+        JSN_STATS_ADD(children_reallocations, 1);
+        struct jsn_node **stack =
+            jsn_realloc(context->stack, sizeof(struct jsn_node *) * capacity);
+
+        // Check allocation success.
+        if (stack == NULL) {
+            jsn_report_failure("Memory allocation failure.");
+            return;
+        }
+
+        context->stack = stack;
+        context->stack_capacity = capacity;
+    }
+
+    context->stack[context->stack_count++] = node;
+}
+
+/**
+ * Moves all children above the given stack base into the node, using a single
+ * exact sized allocation.
+ */
+void jsn_parse_stack_commit(struct jsn_parse_context *context,
+                            struct jsn_node *node, unsigned int base) {
+    jsn_set_node_children(node, &context->stack[base],
+                          context->stack_count - base);
+    context->stack_count = base;
+}
+
+struct jsn_node *jsn_parse_value(struct jsn_parse_context *context,
+                                 struct jsn_token token);
+
+struct jsn_node *jsn_parse_string(struct jsn_parse_context *context,
+                                  struct jsn_token token) {
+    struct jsn_node *node = jsn_create_node(context->arena, JSN_NODE_STRING);
+
+    // Replace the closing quote with a terminator and use the string in place.
+    if (context->insitu) {
+        token.lexeme_start[token.lexeme_length] = '\0';
+        node->value.value_string = token.lexeme_start;
+        return node;
+    }
+
+    // Copy over the token string.
+    jsn_set_node_string(node, token.lexeme_start, token.lexeme_length);
+    JSN_STATS_ADD(strings_copied, 1);
+
+    return node;
+}
+
+struct jsn_node *jsn_parse_null(struct jsn_parse_context *context,
+                                struct jsn_token token) {
+    struct jsn_node *node = jsn_create_node(context->arena, JSN_NODE_NULL);
+    return node;
+}
+
+struct jsn_node *jsn_parse_integer(struct jsn_parse_context *context,
+                                   struct jsn_token token) {
+    struct jsn_node *node;
+
+    // Integer
+    node = jsn_create_node(context->arena, JSN_NODE_INTEGER);
+    node->value.value_integer =
+        jsn_parse_integer_span(token.lexeme_start, token.lexeme_length);
+
+    return node;
+}
+
+struct jsn_node *jsn_parse_double(struct jsn_parse_context *context,
+                                  struct jsn_token token) {
+    struct jsn_node *node;
+
+    // Double
+    node = jsn_create_node(context->arena, JSN_NODE_DOUBLE);
+    node->value.value_double =
+        jsn_parse_number_span(token.lexeme_start, token.lexeme_length);
+
+    return node;
+}
+
+struct jsn_node *jsn_parse_boolean(struct jsn_parse_context *context,
+                                   struct jsn_token token) {
+    struct jsn_node *node;
+    node = jsn_create_node(context->arena, JSN_NODE_BOOLEAN);
+
+    if (token.lexeme_start[0] == 't') {
+        node->value.value_boolean = true;
+    } else {
+        node->value.value_boolean = false;
+    }
+    return node;
+}
+
+struct jsn_node *jsn_parse_array(struct jsn_parse_context *context,
+                                 struct jsn_token token) {
+
+    // Create our array node type.
+    struct jsn_node *node = jsn_create_node(context->arena, JSN_NODE_ARRAY);
+    struct jsn_node *child_node;
+
+    // Children are collected on the scratch stack, above this base.
+    unsigned int stack_base = context->stack_count;
+
+    // While we are not at the end of the array, handle array tokens.
+    while (token.type != JSN_TOC_ARRAY_CLOSE) {
+        token = jsn_parse_next_token(context);
+
+        // Create the new child node (recursive call).
+        child_node = jsn_parse_value(context, token);
+
+        if (child_node != NULL) {
+            jsn_parse_stack_push(context, child_node);
+        }
+    }
+
+    jsn_parse_stack_commit(context, node, stack_base);
+
+    return node;
+}
+
+struct jsn_node *jsn_parse_object(struct jsn_parse_context *context,
+                                  struct jsn_token token) {
+    // Create our object node type.
+    struct jsn_node *node = jsn_create_node(context->arena, JSN_NODE_OBJECT);
+
+    struct jsn_token token_key, token_colon, token_val;
+    struct jsn_node *child_node;
+
+    // Children are collected on the scratch stack, above this base.
+    unsigned int stack_base = context->stack_count;
+
+    // While we haven't reached the end of the object.
+    while (token.type != JSN_TOC_OBJECT_CLOSE) {
+
+        // Get the key.
+        token_key = jsn_parse_next_token(context);
+
+        // It's an empty token, just break and move on.
+        if (token_key.type == JSN_TOC_OBJECT_CLOSE) {
+            break;
+        }
+
+        if (token_key.type != JSN_TOC_STRING) {
+            jsn_report_failure("Unknown token found!");
+            return NULL;
+        }
+
+        // Get the colon.
+        token_colon = jsn_parse_next_token(context);
+        if (token_colon.type != JSN_TOC_COLON) {
+            jsn_report_failure("Unknown token found!");
+            return NULL;
+        }
+
+        // Get the value and create the new child node (recursive call).
+        token_val = jsn_parse_next_token(context);
+        child_node = jsn_parse_value(context, token_val);
+
+        // Point into the source when parsing in-situ, else share the key
+        // with the other objects that use it.
+        if (context->insitu) {
+            token_key.lexeme_start[token_key.lexeme_length] = '\0';
+            child_node->key = token_key.lexeme_start;
+        } else {
+            jsn_parse_intern_key(context, child_node, token_key.lexeme_start,
+                                 token_key.lexeme_length);
+        }
+
+        // Collect the child node.
+        jsn_parse_stack_push(context, child_node);
+
+        /* Set the last token, if this token is a comma, then the next
+           token should be a string key, if not it will report errors above
+           on the next iteration. */
+        token = jsn_parse_next_token(context);
+    }
+
+    jsn_parse_stack_commit(context, node, stack_base);
+
+    return node;
+}
+
+struct jsn_node *jsn_parse_value(struct jsn_parse_context *context,
+                                 struct jsn_token token) {
+    struct jsn_node *node;
+
+    switch (token.type) {
+    case JSN_TOC_OBJECT_OPEN:
+        JSN_STATS_ENTER();
+        node = jsn_parse_object(context, token);
+        JSN_STATS_LEAVE();
+        return node;
+    case JSN_TOC_ARRAY_OPEN:
+        JSN_STATS_ENTER();
+        node = jsn_parse_array(context, token);
+        JSN_STATS_LEAVE();
+        return node;
+    case JSN_TOC_STRING:
+        return jsn_parse_string(context, token);
+    case JSN_TOC_INTEGER:
+        return jsn_parse_integer(context, token);
+    case JSN_TOC_DOUBLE:
+        return jsn_parse_double(context, token);
+    case JSN_TOC_BOOLEAN:
+        return jsn_parse_boolean(context, token);
+    case JSN_TOC_NULL:
+        return jsn_parse_null(context, token);
+    case JSN_TOC_ARRAY_CLOSE:
+    case JSN_TOC_OBJECT_CLOSE:
+    case JSN_TOC_COMMA:
+        return NULL;
+    default:
+        jsn_report_failure("Unknown token found!");
+        return NULL;
+    }
+}
+
+/* BINARY ENCODING:
+ * --------------------------------------------------------------------------*/
+
+/*
+ * Documents are encoded as the magic bytes "JSNB" and a version byte,
+ * followed by the root node. Every node starts with a tag byte:
+ *
+ * - Integers are zigzag encoded varints.
+ * - Doubles are their raw 8 IEEE 754 bytes, in little endian order.
+ * - Strings are a varint length followed by their bytes.
+ * - Arrays are a varint count followed by their items.
+ * - Objects are a varint count followed by key and value pairs. A key is a
+ *   varint, zero is followed by a new key encoded like a string, any other
+ *   number n refers back to the n-th new key of the document.
+ */
+
+#define JSN_BINARY_MAGIC "JSNB"
+#define JSN_BINARY_MAGIC_LENGTH 4
+#define JSN_BINARY_VERSION 1
+
+enum jsn_binary_tag {
+    JSN_BINARY_NULL,
+    JSN_BINARY_INTEGER,
+    JSN_BINARY_DOUBLE,
+    JSN_BINARY_FALSE,
+    JSN_BINARY_TRUE,
+    JSN_BINARY_STRING,
+    JSN_BINARY_ARRAY,
+    JSN_BINARY_OBJECT,
+};
+
+static inline void jsn_writer_put_varint(struct jsn_writer *writer,
+                                         uint64_t value) {
+    jsn_writer_reserve(writer, 10);
+
+    // Seven bits per byte, the high bit marks that more bytes follow.
+    while (value >= 0x80) {
+        writer->data[writer->length++] = (char)(value | 0x80);
+        value >>= 7;
+    }
+    writer->data[writer->length++] = (char)value;
+}
+
+static inline void jsn_writer_put_binary_string(struct jsn_writer *writer,
+                                                const char *string,
+                                                size_t length) {
+    jsn_writer_put_varint(writer, length);
+    jsn_writer_put(writer, string, length);
+}
+
+struct jsn_string_map_slot {
+    const char *string;
+    uint32_t hash;
+    uint32_t value;
+};
+
+/**
+ * Open addressing hash table, that maps the strings written so far to a non
+ * zero value, like their offset in the output.
+ */
+struct jsn_string_map {
+    struct jsn_string_map_slot *slots;
+    unsigned int capacity;
+    unsigned int count;
+};
+
+void jsn_string_map_grow(struct jsn_string_map *map) {
+    unsigned int capacity = map->capacity == 0 ? 64 : map->capacity * 2;
+    struct jsn_string_map_slot *slots =
+        jsn_calloc(capacity, sizeof(struct jsn_string_map_slot));
+    if (slots == NULL) {
+        jsn_report_failure("Memory allocation failure.");
+    }
+
+    for (unsigned int i = 0; i < map->capacity; i++) {
+        if (map->slots[i].string != NULL) {
+            unsigned int slot = map->slots[i].hash & (capacity - 1);
+            while (slots[slot].string != NULL) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            slots[slot] = map->slots[i];
+        }
+    }
+
+    jsn_free_memory(map->slots);
+    map->slots = slots;
+    map->capacity = capacity;
+}
+
+/**
+ * Returns the value of the given string, a new string is added with a value
+ * of zero that the caller should set.
+ */
+uint32_t *jsn_string_map_get(struct jsn_string_map *map, const char *string,
+                             size_t length) {
+    // Keep the load factor at or below one half.
+    if ((map->count + 1) * 2 > map->capacity) {
+        jsn_string_map_grow(map);
+    }
+
+    uint32_t hash = jsn_hash_key(string, length);
+    unsigned int mask = map->capacity - 1;
+    unsigned int slot = hash & mask;
+
+    while (map->slots[slot].string != NULL) {
+        struct jsn_string_map_slot *taken = &map->slots[slot];
+
+        // Parsed documents share their keys, so most matches are pointers.
+        if (taken->string == string ||
+            (taken->hash == hash && strcmp(taken->string, string) == 0)) {
+            return &taken->value;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    map->slots[slot].string = string;
+    map->slots[slot].hash = hash;
+    map->slots[slot].value = 0;
+    map->count++;
+
+    return &map->slots[slot].value;
+}
+
+/**
+ * Writes the binary encoding of a document, keeping track of the keys
+ * written so far.
+ */
+struct jsn_binary_encoder {
+    struct jsn_writer writer;
+    struct jsn_string_map keys;
+};
+
+void jsn_binary_encoder_put_key(struct jsn_binary_encoder *encoder,
+                                const char *key) {
+    size_t length = strlen(key);
+    uint32_t *reference = jsn_string_map_get(&encoder->keys, key, length);
+
+    if (*reference != 0) {
+        jsn_writer_put_varint(&encoder->writer, *reference);
+        return;
+    }
+
+    *reference = encoder->keys.count;
+
+    jsn_writer_put_char(&encoder->writer, 0);
+    jsn_writer_put_binary_string(&encoder->writer, key, length);
+}
+
+void jsn_write_binary_node(struct jsn_binary_encoder *encoder,
+                           jsn_handle handle) {
+    struct jsn_writer *writer = &encoder->writer;
+
+    switch (handle->type) {
+    case JSN_NODE_NULL:
+        jsn_writer_put_char(writer, JSN_BINARY_NULL);
+        break;
+    case JSN_NODE_INTEGER: {
+        // Zigzag encoding keeps small negative integers short.
+        uint32_t value = (uint32_t)handle->value.value_integer;
+        jsn_writer_put_char(writer, JSN_BINARY_INTEGER);
+        jsn_writer_put_varint(writer, (value << 1) ^ (0 - (value >> 31)));
+        break;
+    }
+    case JSN_NODE_DOUBLE: {
+        uint64_t bits;
+        memcpy(&bits, &handle->value.value_double, sizeof(bits));
+
+        jsn_writer_reserve(writer, 9);
+        char *bytes = &writer->data[writer->length];
+        writer->length += 9;
+
+        bytes[0] = JSN_BINARY_DOUBLE;
+        for (unsigned int i = 0; i < 8; i++) {
+            bytes[i + 1] = (char)(bits >> (i * 8));
+        }
+        break;
+    }
+    case JSN_NODE_BOOLEAN:
+        jsn_writer_put_char(writer, handle->value.value_boolean
+                                        ? JSN_BINARY_TRUE
+                                        : JSN_BINARY_FALSE);
+        break;
+    case JSN_NODE_STRING:
+        jsn_writer_put_char(writer, JSN_BINARY_STRING);
+        jsn_writer_put_binary_string(writer, handle->value.value_string,
+                                     strlen(handle->value.value_string));
+        break;
+    case JSN_NODE_ARRAY:
+    case JSN_NODE_OBJECT: {
+        bool object = handle->type == JSN_NODE_OBJECT;
+        jsn_writer_put_char(writer,
+                            object ? JSN_BINARY_OBJECT : JSN_BINARY_ARRAY);
+        jsn_writer_put_varint(writer, handle->children_count);
+
+        for (unsigned int i = 0; i < handle->children_count; i++) {
+            if (object) {
+                jsn_binary_encoder_put_key(encoder, handle->children[i]->key);
+            }
+            jsn_write_binary_node(encoder, handle->children[i]);
+        }
+        break;
+    }
+    }
+}
+
+/**
+ * A key's bytes in the binary data, which aren't null terminated, and the
+ * shared copy once it's interned.
+ */
+struct jsn_binary_key {
+    const char *key;
+    unsigned int length;
+    char *interned;
+};
+
+/**
+ * Reads the binary encoding of a document. Keys are interned and nodes are
+ * allocated the same way the parser does, through it's context.
+ */
+struct jsn_binary_reader {
+    const unsigned char *data;
+    size_t length;
+    size_t position;
+    struct jsn_parse_context context;
+    // The new keys, in the order they were read.
+    struct jsn_binary_key *keys;
+    unsigned int keys_count;
+    unsigned int keys_capacity;
+};
+
+static inline void jsn_binary_reader_require(struct jsn_binary_reader *reader,
+                                             size_t count) {
+    if (reader->length - reader->position < count) {
+        jsn_report_failure("Invalid binary data found!");
+    }
+}
+
+static inline uint64_t
+jsn_binary_read_varint(struct jsn_binary_reader *reader) {
+    uint64_t value = 0;
+
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        jsn_binary_reader_require(reader, 1);
+        unsigned char byte = reader->data[reader->position++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+
+    jsn_report_failure("Invalid binary data found!");
+    return 0;
+}
+
+/**
+ * Reads a string's length and makes sure all of it's bytes are available.
+ */
+static inline size_t
+jsn_binary_read_string_length(struct jsn_binary_reader *reader) {
+    uint64_t length = jsn_binary_read_varint(reader);
+    jsn_binary_reader_require(reader, length);
+    return (size_t)length;
+}
+
+/**
+ * Reads an object's key, either a new key or a reference to an earlier one.
+ * Returns the key's index in the reader's keys.
+ */
+unsigned int jsn_binary_read_key(struct jsn_binary_reader *reader) {
+    uint64_t reference = jsn_binary_read_varint(reader);
+
+    if (reference > reader->keys_count) {
+        jsn_report_failure("Invalid binary data found!");
+    }
+
+    if (reference != 0) {
+        return (unsigned int)(reference - 1);
+    }
+
+    size_t length = jsn_binary_read_string_length(reader);
+    if (length > UINT_MAX) {
+        jsn_report_failure("Invalid binary data found!");
+    }
+
+    struct jsn_binary_key key;
+    key.key = (const char *)&reader->data[reader->position];
+    key.length = (unsigned int)length;
+    key.interned = NULL;
+    reader->position += length;
+
+    if (reader->keys_count == reader->keys_capacity) {
+        unsigned int capacity =
+            reader->keys_capacity == 0 ? 64 : reader->keys_capacity * 2;
+        struct jsn_binary_key *keys =
+            jsn_realloc(reader->keys, sizeof(struct jsn_binary_key) * capacity);
+        if (keys == NULL) {
+            jsn_report_failure("Memory allocation failure.");
+        }
+
+        reader->keys = keys;
+        reader->keys_capacity = capacity;
+    }
+
+    reader->keys[reader->keys_count] = key;
+
+    return reader->keys_count++;
+}
+
+/**
+ * Sets the child's key, a key that was interned before is shared without
+ * hashing it again.
+ */
+void jsn_binary_set_key(struct jsn_binary_reader *reader,
+                        struct jsn_node *child, unsigned int index) {
+    struct jsn_binary_key *key = &reader->keys[index];
+
+    if (jsn_set_node_inline_key(child, key->key, key->length)) {
+        JSN_STATS_ADD(keys_copied, 1);
+        return;
+    }
+
+    if (key->interned == NULL) {
+        jsn_parse_intern_key(&reader->context, child, key->key, key->length);
+        key->interned = child->key;
+        return;
+    }
+
+    child->key = key->interned;
+    if (reader->context.arena == NULL) {
+        jsn_interned_key_of(child->key)->references++;
+        child->key_interned = true;
+    }
+}
+
+struct jsn_node *jsn_read_binary_node(struct jsn_binary_reader *reader) {
+    struct jsn_arena *arena = reader->context.arena;
+
+    jsn_binary_reader_require(reader, 1);
+    unsigned char tag = reader->data[reader->position++];
+
+    struct jsn_node *node;
+
+    switch (tag) {
+    case JSN_BINARY_NULL:
+        return jsn_create_node(arena, JSN_NODE_NULL);
+    case JSN_BINARY_INTEGER: {
+        uint64_t value = jsn_binary_read_varint(reader);
+        if (value > UINT32_MAX) {
+            jsn_report_failure("Invalid binary data found!");
+        }
+
+        uint32_t zigzag = (uint32_t)value;
+        node = jsn_create_node(arena, JSN_NODE_INTEGER);
+        node->value.value_integer = (int)((zigzag >> 1) ^ (0 - (zigzag & 1)));
+        return node;
+    }
+    case JSN_BINARY_DOUBLE: {
+        jsn_binary_reader_require(reader, 8);
+
+        const unsigned char *bytes = &reader->data[reader->position];
+        reader->position += 8;
+
+        uint64_t bits = 0;
+        for (unsigned int i = 0; i < 8; i++) {
+            bits |= (uint64_t)bytes[i] << (i * 8);
+        }
+
+        node = jsn_create_node(arena, JSN_NODE_DOUBLE);
+        memcpy(&node->value.value_double, &bits, sizeof(bits));
+        return node;
+    }
+    case JSN_BINARY_FALSE:
+    case JSN_BINARY_TRUE:
+        node = jsn_create_node(arena, JSN_NODE_BOOLEAN);
+        node->value.value_boolean = tag == JSN_BINARY_TRUE;
+        return node;
+    case JSN_BINARY_STRING: {
+        size_t length = jsn_binary_read_string_length(reader);
+        const char *string = (const char *)&reader->data[reader->position];
+        reader->position += length;
+
+        node = jsn_create_node(arena, JSN_NODE_STRING);
+        jsn_set_node_string(node, string, length);
+        return node;
+    }
+    case JSN_BINARY_ARRAY:
+    case JSN_BINARY_OBJECT: {
+        bool object = tag == JSN_BINARY_OBJECT;
+        uint64_t count = jsn_binary_read_varint(reader);
+
+        // Every child takes at least one byte, which also rejects counts
+        // that would overflow the allocation below.
+        if (count > UINT32_MAX || count > reader->length - reader->position) {
+            jsn_report_failure("Invalid binary data found!");
+        }
+
+        node = jsn_create_node(arena,
+                               object ? JSN_NODE_OBJECT : JSN_NODE_ARRAY);
+        if (count == 0) {
+            return node;
+        }
+
+        // The count is known up front, so the children are read straight
+        // into an exact sized array.
+        node->children = jsn_alloc(arena, sizeof(struct jsn_node *) * count);
+        node->children_capacity = (unsigned int)count;
+
+        for (unsigned int i = 0; i < count; i++) {
+            // The key comes before the value, so it's only set once the
+            // value's node exists.
+            unsigned int key = 0;
+            if (object) {
+                key = jsn_binary_read_key(reader);
+            }
+
+            struct jsn_node *child = jsn_read_binary_node(reader);
+            if (object) {
+                jsn_binary_set_key(reader, child, key);
+            }
+
+            node->children[i] = child;
+            node->children_count++;
+        }
+
+        jsn_key_index_prepare(node);
+        return node;
+    }
+    default:
+        jsn_report_failure("Invalid binary data found!");
+        return NULL;
+    }
+}
+
+/* FROZEN SNAPSHOTS:
+ * --------------------------------------------------------------------------*/
+
+/*
+ * A snapshot is a whole document laid out without any pointers, so that it
+ * can be memory mapped and read in place. It starts with a header, which
+ * records the snapshot's total length, followed by the root node's record.
+ * Every record has a fixed size:
+ *
+ * - Integers, doubles and booleans are stored in the record itself.
+ * - Strings are the offset of their null terminated bytes.
+ * - Arrays and objects are the offset of their children's records, which are
+ *   stored next to each other. Objects follow them with the offsets of their
+ *   keys and, for large objects, a copy of their key index.
+ *
+ * Offsets are relative to the start of the snapshot and equal strings are
+ * only stored once. Snapshots use the byte order of the machine that wrote
+ * them.
+ */
+
+#define JSN_SNAPSHOT_MAGIC "JSNF"
+#define JSN_SNAPSHOT_MAGIC_LENGTH 4
+#define JSN_SNAPSHOT_VERSION 2
+#define JSN_SNAPSHOT_BYTE_ORDER 0x01020304
+
+struct jsn_snapshot_header {
+    char magic[JSN_SNAPSHOT_MAGIC_LENGTH];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t root;
+    uint32_t length;
+};
+
+struct jsn_frozen_node {
+    uint32_t type;
+    uint32_t children_count;
+    union {
+        int64_t value_integer;
+        double value_double;
+        uint64_t value_boolean;
+        // Offset of the string, or of the children's records.
+        uint64_t offset;
+    } value;
+};
+
+struct jsn_snapshot {
+    struct jsn_source source;
+};
+
+/**
+ * Lays out a document in a snapshot, the strings written so far are mapped to
+ * their offsets.
+ */
+struct jsn_freezer {
+    struct jsn_writer writer;
+    struct jsn_string_map strings;
+};
+
+/**
+ * Reserves zeroed space at the end of the snapshot, and returns it's offset.
+ * The offset is aligned for records.
+ */
+uint32_t jsn_freezer_reserve(struct jsn_freezer *freezer, size_t size) {
+    struct jsn_writer *writer = &freezer->writer;
+    size_t padding = (8 - writer->length % 8) % 8;
+
+    if (writer->length + padding + size > UINT32_MAX) {
+        jsn_report_failure("The snapshot is too large.");
+    }
+
+    jsn_writer_reserve(writer, padding + size);
+    memset(&writer->data[writer->length], 0, padding + size);
+    writer->length += padding;
+
+    uint32_t offset = (uint32_t)writer->length;
+    writer->length += size;
+
+    return offset;
+}
+
+uint32_t jsn_freezer_put_string(struct jsn_freezer *freezer,
+                                const char *string) {
+    size_t length = strlen(string);
+    uint32_t *offset = jsn_string_map_get(&freezer->strings, string, length);
+
+    // Strings that were already written are shared.
+    if (*offset == 0) {
+        struct jsn_writer *writer = &freezer->writer;
+        if (writer->length + length + 1 > UINT32_MAX) {
+            jsn_report_failure("The snapshot is too large.");
+        }
+
+        *offset = (uint32_t)writer->length;
+        jsn_writer_put(writer, string, length + 1);
+    }
+
+    return *offset;
+}
+
+uint32_t jsn_freezer_put_children(struct jsn_freezer *freezer,
+                                  jsn_handle handle);
+
+/**
+ * Fills in the record of the given node, writing out what it refers to.
+ */
+void jsn_freezer_put_node(struct jsn_freezer *freezer, jsn_handle handle,
+                          uint32_t record_offset) {
+    struct jsn_frozen_node record;
+    memset(&record, 0, sizeof(record));
+    record.type = handle->type;
+
+    switch (handle->type) {
+    case JSN_NODE_NULL:
+        break;
+    case JSN_NODE_INTEGER:
+        record.value.value_integer = handle->value.value_integer;
+        break;
+    case JSN_NODE_DOUBLE:
+        record.value.value_double = handle->value.value_double;
+        break;
+    case JSN_NODE_BOOLEAN:
+        record.value.value_boolean = handle->value.value_boolean;
+        break;
+    case JSN_NODE_STRING:
+        record.value.offset =
+            jsn_freezer_put_string(freezer, handle->value.value_string);
+        break;
+    case JSN_NODE_ARRAY:
+    case JSN_NODE_OBJECT:
+        record.children_count = handle->children_count;
+        record.value.offset = jsn_freezer_put_children(freezer, handle);
+        break;
+    }
+
+    // The writer's data moves as it grows, so the record is copied in last.
+    memcpy(&freezer->writer.data[record_offset], &record, sizeof(record));
+}
+
+/**
+ * Writes the records of the node's children, followed by the keys of an
+ * object. Returns the offset of the records.
+ */
+uint32_t jsn_freezer_put_children(struct jsn_freezer *freezer,
+                                  jsn_handle handle) {
+    unsigned int count = handle->children_count;
+    if (count == 0) {
+        return 0;
+    }
+
+    bool object = handle->type == JSN_NODE_OBJECT;
+
+    // Large objects take their key index along, the slots refer to the
+    // children by their position, which stays the same.
+    struct jsn_key_index *index = NULL;
+    if (object && count >= JSN_KEY_INDEX_THRESHOLD) {
+        index = handle->key_index;
+    }
+
+    size_t size = sizeof(struct jsn_frozen_node) * count;
+    if (object) {
+        size += sizeof(uint32_t) * count;
+    }
+    if (index != NULL) {
+        size += sizeof(uint32_t) +
+                sizeof(struct jsn_key_index_slot) * index->capacity;
+    }
+
+    uint32_t records = jsn_freezer_reserve(freezer, size);
+    uint32_t keys = records + sizeof(struct jsn_frozen_node) * count;
+
+    if (index != NULL) {
+        size_t index_offset = keys + sizeof(uint32_t) * count;
+        char *index_data = &freezer->writer.data[index_offset];
+        memcpy(index_data, &index->capacity, sizeof(uint32_t));
+        memcpy(index_data + sizeof(uint32_t), index->slots,
+               sizeof(struct jsn_key_index_slot) * index->capacity);
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        struct jsn_node *child = handle->children[i];
+
+        if (object) {
+            uint32_t key = jsn_freezer_put_string(freezer, child->key);
+            memcpy(&freezer->writer.data[keys + sizeof(uint32_t) * i], &key,
+                   sizeof(uint32_t));
+        }
+
+        jsn_freezer_put_node(freezer, child,
+                             records + sizeof(struct jsn_frozen_node) * i);
+    }
+
+    return records;
+}
+
+static inline const struct jsn_frozen_node *
+jsn_frozen_node_of(struct jsn_frozen frozen) {
+    return (const struct jsn_frozen_node *)&frozen.image[frozen.offset];
+}
+
+static inline struct jsn_frozen jsn_frozen_child(struct jsn_frozen frozen,
+                                                 unsigned int index) {
+    const struct jsn_frozen_node *node = jsn_frozen_node_of(frozen);
+    frozen.offset = node->value.offset + sizeof(struct jsn_frozen_node) * index;
+    return frozen;
+}
+
+static inline const char *jsn_frozen_child_key(struct jsn_frozen frozen,
+                                               unsigned int index) {
+    const struct jsn_frozen_node *node = jsn_frozen_node_of(frozen);
+    const char *keys = &frozen.image[node->value.offset +
+                                     sizeof(struct jsn_frozen_node) *
+                                         node->children_count];
+
+    uint32_t key;
+    memcpy(&key, keys + sizeof(uint32_t) * index, sizeof(uint32_t));
+    return &frozen.image[key];
+}
+
+/**
+ * Returns the index of the object's first child with the given key, or -1
+ * when no such child exists. Just like jsn_get_node_direct_child_index.
+ */
+int jsn_frozen_find_key(struct jsn_frozen frozen, const char *key) {
+    const struct jsn_frozen_node *node = jsn_frozen_node_of(frozen);
+    unsigned int count = node->children_count;
+
+    if (node->type != JSN_NODE_OBJECT) {
+        return -1;
+    }
+
+    // Small objects are just scanned.
+    if (count < JSN_KEY_INDEX_THRESHOLD) {
+        for (unsigned int i = 0; i < count; i++) {
+            if (strcmp(jsn_frozen_child_key(frozen, i), key) == 0) {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    const char *index = &frozen.image[node->value.offset +
+                                      (sizeof(struct jsn_frozen_node) +
+                                       sizeof(uint32_t)) *
+                                          count];
+    uint32_t capacity;
+    memcpy(&capacity, index, sizeof(uint32_t));
+    const struct jsn_key_index_slot *slots =
+        (const struct jsn_key_index_slot *)(index + sizeof(uint32_t));
+
+    uint32_t hash = jsn_hash_key(key, strlen(key));
+    unsigned int mask = capacity - 1;
+    unsigned int slot = hash & mask;
+
+    while (slots[slot].child != 0) {
+        unsigned int child = slots[slot].child - 1;
+
+        if (slots[slot].hash == hash &&
+            strcmp(jsn_frozen_child_key(frozen, child), key) == 0) {
+            return child;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return -1;
+}
+
+/* THREADS:
+ * --------------------------------------------------------------------------*/
+
+/**
+ * Returns the number of threads to use, zero threads uses one per online CPU.
+ * There's no use in more threads than there are tasks.
+ */
+unsigned int jsn_thread_count(unsigned int thread_count, size_t task_count) {
+#ifdef JSN_THREADS
+    if (thread_count == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = online > 0 ? (unsigned int)online : 1;
+    }
+#else
+    thread_count = 1;
+#endif
+
+    if (thread_count > task_count) {
+        thread_count = task_count;
+    }
+
+    return thread_count;
+}
+
+/**
+ * Runs the worker on the given number of threads, the calling thread being
+ * one of them, and waits for all of them to return. Workers take their tasks
+ * from the shared argument.
+ */
+void jsn_run_workers(void *(*worker)(void *), void *argument,
+                     unsigned int thread_count, size_t task_count) {
+    thread_count = jsn_thread_count(thread_count, task_count);
+
+#ifdef JSN_THREADS
+    pthread_t *threads = jsn_malloc(sizeof(pthread_t) * thread_count);
+    unsigned int started = 0;
+
+    // Fewer threads are used when they can't be created.
+    if (threads != NULL) {
+        while (started + 1 < thread_count &&
+               pthread_create(&threads[started], NULL, worker, argument) ==
+                   0) {
+            started++;
+        }
+    }
+
+    worker(argument);
+
+    for (unsigned int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    jsn_free_memory(threads);
+#else
+    worker(argument);
+#endif
+}
+
+// Hands out the index of the next task to the workers, tasks are taken until
+// the index reaches the task count.
+#ifdef JSN_THREADS
+typedef atomic_size_t jsn_task_counter;
+#define jsn_take_task(counter) atomic_fetch_add((counter), 1)
+#else
+typedef size_t jsn_task_counter;
+#define jsn_take_task(counter) ((*(counter))++)
+#endif
+
+/* NDJSON:
+ * --------------------------------------------------------------------------*/
+
+// Newline delimited JSON is split into chunks of about this size, that are
+// parsed by the worker threads.
+#define JSN_NDJSON_CHUNK_SIZE (1 << 20)
+
+jsn_handle jsn_parse_source(char *source, size_t source_length, bool insitu);
+
+struct jsn_ndjson_chunk {
+    const char *start;
+    const char *end;
+    // The chunk's records in input order, unless they are handed to a
+    // callback instead.
+    jsn_handle *records;
+    size_t count;
+    size_t capacity;
+};
+
+struct jsn_ndjson_job {
+    struct jsn_ndjson_chunk *chunks;
+    size_t chunk_count;
+    // The next chunk that no worker has taken yet.
+    jsn_task_counter next_chunk;
+    void (*callback)(void *user_data, jsn_handle record);
+    void *user_data;
+};
+
+void jsn_ndjson_chunk_push(struct jsn_ndjson_chunk *chunk, jsn_handle record) {
+    if (chunk->count == chunk->capacity) {
+        size_t capacity = chunk->capacity == 0 ? 64 : chunk->capacity * 2;
+        jsn_handle *records =
+            jsn_realloc(chunk->records, sizeof(jsn_handle) * capacity);
+
+        // Check allocation success.
+        if (records == NULL) {
+            jsn_report_failure("Memory allocation failure.");
+            return;
+        }
+
+        chunk->records = records;
+        chunk->capacity = capacity;
+    }
+
+    chunk->records[chunk->count++] = record;
+}
+
+/**
+ * Parses every line of the chunk into it's own document, blank lines are
+ * skipped.
+ */
+void jsn_ndjson_parse_chunk(struct jsn_ndjson_job *job,
+                            struct jsn_ndjson_chunk *chunk) {
+    const char *line = chunk->start;
+
+    while (line < chunk->end) {
+        const char *newline = memchr(line, '\n', chunk->end - line);
+        const char *line_end = newline != NULL ? newline : chunk->end;
+
+        const char *cursor = line;
+        while (cursor < line_end && isspace((unsigned char)*cursor)) {
+            cursor++;
+        }
+
+        if (cursor < line_end) {
+            // The source is only read, it's never parsed in-situ.
+            jsn_handle record =
+                jsn_parse_source((char *)cursor, line_end - cursor, false);
+
+            if (job->callback != NULL) {
+                job->callback(job->user_data, record);
+            } else {
+                jsn_ndjson_chunk_push(chunk, record);
+            }
+        }
+
+        line = line_end + 1;
+    }
+}
+
+void *jsn_ndjson_worker(void *argument) {
+    struct jsn_ndjson_job *job = argument;
+
+    // Take chunks until there are none left, so that workers that get
+    // quick chunks simply take more of them.
+    while (true) {
+        size_t index = jsn_take_task(&job->next_chunk);
+
+        if (index >= job->chunk_count) {
+            return NULL;
+        }
+
+        jsn_ndjson_parse_chunk(job, &job->chunks[index]);
+    }
+}
+
+/**
+ * Splits the buffer into chunks at newlines, and parses them on the given
+ * number of threads. Zero threads uses one per online CPU.
+ */
+void jsn_ndjson_run(struct jsn_ndjson_job *job, const char *buffer,
+                    size_t length, unsigned int thread_count) {
+    const char *end = buffer + length;
+
+    job->chunk_count = 0;
+    job->chunks = jsn_malloc(sizeof(struct jsn_ndjson_chunk) *
+                             (length / JSN_NDJSON_CHUNK_SIZE + 1));
+
+    // Check allocation success.
+    if (job->chunks == NULL) {
+        jsn_report_failure("Memory allocation failure.");
+        return;
+    }
+
+    // Records can't contain raw newlines, so every chunk ends right after
+    // one, except for the last.
+    const char *start = buffer;
+    while (start < end) {
+        const char *chunk_end = end;
+
+        if ((size_t)(end - start) > JSN_NDJSON_CHUNK_SIZE) {
+            const char *newline = memchr(start + JSN_NDJSON_CHUNK_SIZE, '\n',
+                                         end - start - JSN_NDJSON_CHUNK_SIZE);
+            if (newline != NULL) {
+                chunk_end = newline + 1;
+            }
+        }
+
+        struct jsn_ndjson_chunk *chunk = &job->chunks[job->chunk_count++];
+        chunk->start = start;
+        chunk->end = chunk_end;
+        chunk->records = NULL;
+        chunk->count = 0;
+        chunk->capacity = 0;
+
+        start = chunk_end;
+    }
+
+    job->next_chunk = 0;
+
+    jsn_run_workers(jsn_ndjson_worker, job, thread_count, job->chunk_count);
+}
+
+/* PARALLEL PARSER:
+ * --------------------------------------------------------------------------*/
+
+// Documents with an array root are parsed in parallel from this size on.
+#define JSN_PARALLEL_MIN_LENGTH (1 << 22)
+
+// The array is split into ranges of at least this size, with a few ranges
+// per thread so that they balance out.
+#define JSN_PARALLEL_RANGE_MIN_LENGTH (1 << 20)
+#define JSN_PARALLEL_RANGES_PER_THREAD 4
+
+/**
+ * A run of the root array's items, between two of it's top level commas.
+ */
+struct jsn_parallel_range {
+    size_t start;
+    size_t end;
+    // The last range ends with the array's closing bracket.
+    bool last;
+    // The range's items are collected on the context's stack.
+    struct jsn_parse_context context;
+};
+
+struct jsn_parallel_job {
+    char *source;
+    bool insitu;
+    // The document's arena, NULL when not in arena mode.
+    struct jsn_arena *arena;
+    struct jsn_parallel_range *ranges;
+    size_t range_count;
+    jsn_task_counter next_range;
+};
+
+/**
+ * Finds the root array's top level commas, the first one at or after each of
+ * the evenly spaced targets. The array's items start at the given offset.
+ * Returns the number of commas found.
+ */
+size_t jsn_parallel_find_splits(const char *source, size_t length,
+                                size_t start, size_t *splits,
+                                size_t split_count) {
+    jsn_block_classifier classify = jsn_classify_block_kernel;
+    if (jsn_options & JSN_OPTION_SCALAR) {
+        classify = jsn_classify_block_scalar;
+    }
+
+    size_t found = 0;
+    size_t spacing = (length - start) / (split_count + 1);
+    size_t target = start + spacing;
+    unsigned int depth = 1;
+
+    uint64_t escaped_carry = 0;
+    uint64_t in_string_carry = 0;
+
+    struct jsn_block_masks masks;
+    char padded_block[JSN_BLOCK_SIZE];
+
+    for (size_t offset = start; offset < length; offset += JSN_BLOCK_SIZE) {
+        const char *block = &source[offset];
+
+        // The last block is padded with spaces.
+        if (length - offset < JSN_BLOCK_SIZE) {
+            memset(padded_block, ' ', JSN_BLOCK_SIZE);
+            memcpy(padded_block, block, length - offset);
+            block = padded_block;
+        }
+
+        classify(block, &masks);
+
+        // Only operators outside of strings change the depth, the same way
+        // the structural index finds them.
+        uint64_t escaped = jsn_find_escaped(masks.backslash, &escaped_carry);
+        uint64_t quotes = masks.quote & ~escaped;
+        uint64_t in_string = jsn_prefix_xor(quotes) ^ in_string_carry;
+        in_string_carry = (uint64_t)((int64_t)in_string >> 63);
+
+        uint64_t operators = masks.operators & ~in_string;
+
+        while (operators != 0) {
+            unsigned int bit = __builtin_ctzll(operators);
+            operators &= operators - 1;
+
+            switch (block[bit]) {
+            case '[':
+            case '{':
+                depth++;
+                break;
+            case ']':
+            case '}':
+                // The end of the root array.
+                if (--depth == 0) {
+                    return found;
+                }
+                break;
+            case ',':
+                if (depth == 1 && offset + bit >= target) {
+                    splits[found++] = offset + bit;
+                    target += spacing;
+
+                    if (found == split_count) {
+                        return found;
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    return found;
+}
+
+/**
+ * Returns true if there are no more tokens to be read.
+ */
+static inline bool
+jsn_parse_context_at_end(struct jsn_parse_context *context) {
+    if (context->indexed) {
+        return context->index.next == context->index.count;
+    }
+
+    struct jsn_tokenizer *tokenizer = &context->tokenizer;
+    while (tokenizer->source_cursor < tokenizer->source_length &&
+           isspace(tokenizer->source[tokenizer->source_cursor])) {
+        tokenizer->source_cursor++;
+    }
+
+    return tokenizer->source_cursor == tokenizer->source_length;
+}
+
+/**
+ * Points the node and all of it's descendants at the given arena.
+ */
+void jsn_set_node_arena(struct jsn_node *node, struct jsn_arena *arena) {
+    node->arena = arena;
+
+    for (unsigned int i = 0; i < node->children_count; i++) {
+        jsn_set_node_arena(node->children[i], arena);
+    }
+}
+
+/**
+ * Parses the items of a range, just like jsn_parse_array parses them.
+ */
+void jsn_parallel_parse_range(struct jsn_parallel_job *job,
+                              struct jsn_parallel_range *range) {
+    struct jsn_parse_context *context = &range->context;
+    jsn_parse_context_init_tokens(context, &job->source[range->start],
+                                  range->end - range->start);
+
+    // Every range allocates from an arena of it's own, they are merged into
+    // the document's arena once all ranges are parsed.
+    if (job->arena != NULL) {
+        context->arena = jsn_arena_create();
+    }
+    context->insitu = job->insitu;
+
+    while (range->last || jsn_parse_context_at_end(context) == false) {
+        struct jsn_token token = jsn_parse_next_token(context);
+
+        if (token.type == JSN_TOC_ARRAY_CLOSE) {
+            break;
+        }
+
+        struct jsn_node *child_node = jsn_parse_value(context, token);
+
+        if (child_node != NULL) {
+            jsn_parse_stack_push(context, child_node);
+        }
+    }
+
+    if (job->arena != NULL) {
+        for (unsigned int i = 0; i < context->stack_count; i++) {
+            jsn_set_node_arena(context->stack[i], job->arena);
+        }
+    }
+}
+
+void *jsn_parallel_worker(void *argument) {
+    struct jsn_parallel_job *job = argument;
+
+    while (true) {
+        size_t index = jsn_take_task(&job->next_range);
+
+        if (index >= job->range_count) {
+            return NULL;
+        }
+
+        jsn_parallel_parse_range(job, &job->ranges[index]);
+    }
+}
+
+/**
+ * Parses a document with an array root on multiple threads. The array is
+ * split at it's top level commas into ranges, that are each parsed on their
+ * own. Their items are then joined into the root array.
+ */
+jsn_handle jsn_parse_parallel(char *source, size_t source_length,
+                              size_t array_start, bool insitu) {
+    size_t thread_count = jsn_thread_count(jsn_parallel_threads, SIZE_MAX);
+
+    size_t range_count = source_length / JSN_PARALLEL_RANGE_MIN_LENGTH;
+    if (range_count > thread_count * JSN_PARALLEL_RANGES_PER_THREAD) {
+        range_count = thread_count * JSN_PARALLEL_RANGES_PER_THREAD;
+    }
+
+    size_t *splits = jsn_malloc(sizeof(size_t) * range_count);
+    struct jsn_parallel_range *ranges =
+        jsn_malloc(sizeof(struct jsn_parallel_range) * range_count);
+
+    // Check allocation success.
+    if (splits == NULL || ranges == NULL) {
+        jsn_report_failure("Memory allocation failure.");
+        return NULL;
+    }
+
+    size_t split_count = jsn_parallel_find_splits(
+        source, source_length, array_start + 1, splits, range_count - 1);
+
+    struct jsn_parallel_job job;
+    job.source = source;
+    job.insitu = insitu;
+    job.arena = NULL;
+    job.ranges = ranges;
+    job.range_count = split_count + 1;
+    job.next_range = 0;
+
+    if ((jsn_options & JSN_OPTION_ARENA) || insitu) {
+        job.arena = jsn_arena_create();
+    }
+
+    // The ranges are separated by the commas, which are skipped.
+    for (size_t i = 0; i < job.range_count; i++) {
+        ranges[i].start = i == 0 ? array_start + 1 : splits[i - 1] + 1;
+        ranges[i].end = i == split_count ? source_length : splits[i];
+        ranges[i].last = i == split_count;
+    }
+    jsn_free_memory(splits);
+
+    jsn_run_workers(jsn_parallel_worker, &job, 0, job.range_count);
+
+    struct jsn_node *node = jsn_create_node(job.arena, JSN_NODE_ARRAY);
+
+    unsigned int count = 0;
+    for (size_t i = 0; i < job.range_count; i++) {
+        count += ranges[i].context.stack_count;
+    }
+
+    // Join the ranges' items, in order, using a single allocation.
+    if (count != 0) {
+        size_t size = sizeof(struct jsn_node *) * count;
+        node->children = jsn_alloc(job.arena, size);
+        node->children_capacity = count;
+    }
+
+    for (size_t i = 0; i < job.range_count; i++) {
+        struct jsn_parse_context *context = &ranges[i].context;
+
+        memcpy(&node->children[node->children_count], context->stack,
+               sizeof(struct jsn_node *) * context->stack_count);
+        node->children_count += context->stack_count;
+
+        if (context->arena != NULL) {
+            jsn_arena_merge(job.arena, context->arena);
+        }
+        jsn_parse_context_free(context);
+    }
+    jsn_free_memory(ranges);
+
+    // The root node releases the document's arena.
+    if (job.arena != NULL) {
+        job.arena->owner = node;
+    }
+
+    return node;
+}
+
+/* EVENT PARSER:
+ * --------------------------------------------------------------------------*/
+
+/*
+ * The event parser walks the same tokens as the recursive parser, but instead
+ * of creating nodes it calls the handler's callbacks. Nothing is allocated
+ * per value, strings and keys are handed out as spans of the source.
+ */
+
+struct jsn_events {
+    struct jsn_parse_context context;
+    const struct jsn_handler *handler;
+    void *user_data;
+};
+
+void jsn_events_parse_value(struct jsn_events *events, struct jsn_token token);
+
+void jsn_events_parse_array(struct jsn_events *events, struct jsn_token token) {
+    if (events->handler->on_array_start != NULL) {
+        events->handler->on_array_start(events->user_data);
+    }
+
+    // Commas and the closing bracket are skipped by the value parser.
+    while (token.type != JSN_TOC_ARRAY_CLOSE) {
+        token = jsn_parse_next_token(&events->context);
+        jsn_events_parse_value(events, token);
+    }
+
+    if (events->handler->on_array_end != NULL) {
+        events->handler->on_array_end(events->user_data);
+    }
+}
+
+void jsn_events_parse_object(struct jsn_events *events,
+                             struct jsn_token token) {
+    const struct jsn_handler *handler = events->handler;
+    struct jsn_token token_key, token_colon;
+
+    if (handler->on_object_start != NULL) {
+        handler->on_object_start(events->user_data);
+    }
+
+    // While we haven't reached the end of the object.
+    while (token.type != JSN_TOC_OBJECT_CLOSE) {
+        token_key = jsn_parse_next_token(&events->context);
+
+        // It's an empty token, just break and move on.
+        if (token_key.type == JSN_TOC_OBJECT_CLOSE) {
+            break;
+        }
+
+        if (token_key.type != JSN_TOC_STRING) {
+            jsn_report_failure("Unknown token found!");
+            return;
+        }
+
+        token_colon = jsn_parse_next_token(&events->context);
+        if (token_colon.type != JSN_TOC_COLON) {
+            jsn_report_failure("Unknown token found!");
+            return;
+        }
+
+        if (handler->on_key != NULL) {
+            handler->on_key(events->user_data, token_key.lexeme_start,
+                            token_key.lexeme_length);
+        }
+
+        jsn_events_parse_value(events, jsn_parse_next_token(&events->context));
+
+        // Either a comma or the end of the object.
+        token = jsn_parse_next_token(&events->context);
+    }
+
+    if (handler->on_object_end != NULL) {
+        handler->on_object_end(events->user_data);
+    }
+}
+
+void jsn_events_parse_value(struct jsn_events *events, struct jsn_token token) {
+    const struct jsn_handler *handler = events->handler;
+
+    switch (token.type) {
+    case JSN_TOC_OBJECT_OPEN:
+        jsn_events_parse_object(events, token);
+        return;
+    case JSN_TOC_ARRAY_OPEN:
+        jsn_events_parse_array(events, token);
+        return;
+    case JSN_TOC_STRING:
+        if (handler->on_string != NULL) {
+            handler->on_string(events->user_data, token.lexeme_start,
+                               token.lexeme_length);
+        }
+        return;
+    case JSN_TOC_INTEGER:
+        if (handler->on_integer != NULL) {
+            int value =
+                jsn_parse_integer_span(token.lexeme_start, token.lexeme_length);
+            handler->on_integer(events->user_data, value);
+        }
+        return;
+    case JSN_TOC_DOUBLE:
+        if (handler->on_double != NULL) {
+            double value =
+                jsn_parse_number_span(token.lexeme_start, token.lexeme_length);
+            handler->on_double(events->user_data, value);
+        }
+        return;
+    case JSN_TOC_BOOLEAN:
+        if (handler->on_boolean != NULL) {
+            bool value = token.lexeme_start[0] == 't';
+            handler->on_boolean(events->user_data, value);
+        }
+        return;
+    case JSN_TOC_NULL:
+        if (handler->on_null != NULL) {
+            handler->on_null(events->user_data);
+        }
+        return;
+    case JSN_TOC_ARRAY_CLOSE:
+    case JSN_TOC_OBJECT_CLOSE:
+    case JSN_TOC_COMMA:
+        return;
+    default:
+        jsn_report_failure("Unknown token found!");
+    }
+}
+
+void jsn_events_parse_source(char *source, size_t source_length,
+                             const struct jsn_handler *handler,
+                             void *user_data) {
+    struct jsn_events events;
+    events.handler = handler;
+    events.user_data = user_data;
+
+    jsn_parse_context_init_tokens(&events.context, source, source_length);
+    jsn_events_parse_value(&events, jsn_parse_next_token(&events.context));
+    jsn_parse_context_free(&events.context);
+}
+
+/* TAPE:
+ * --------------------------------------------------------------------------*/
+
+/*
+ * A tape is a read only document laid out as a single array of 8 byte
+ * entries, in the order of the source. The top byte of an entry is it's tag,
+ * the other 56 bits are it's payload:
+ *
+ * - Integers hold their value, booleans and null only have their tag.
+ * - Doubles are followed by an extra entry that holds their IEEE 754 bits.
+ * - Strings hold the offset of their length and bytes in the string buffer.
+ * - Arrays and objects hold the index of their end entry in the low 32 bits
+ *   and their number of items in the high 24 bits, saturated. The end entry
+ *   holds the index of the start entry. Each of an object's values is
+ *   preceded by it's key, which is a string entry.
+ *
+ * Skipping a value is a single jump, so values are found without following
+ * any pointers.
+ */
+
+#define JSN_TAPE_PAYLOAD_MASK ((UINT64_C(1) << 56) - 1)
+#define JSN_TAPE_COUNT_MAX 0xFFFFFF
+
+enum jsn_tape_tag {
+    JSN_TAPE_NULL,
+    JSN_TAPE_INTEGER,
+    JSN_TAPE_DOUBLE,
+    JSN_TAPE_FALSE,
+    JSN_TAPE_TRUE,
+    JSN_TAPE_STRING,
+    JSN_TAPE_ARRAY,
+    JSN_TAPE_OBJECT,
+    JSN_TAPE_END,
+};
+
+struct jsn_tape {
+    uint64_t *entries;
+    size_t count;
+    size_t capacity;
+    // Every string is it's 32 bit length followed by it's null terminated
+    // bytes.
+    char *strings;
+    size_t strings_length;
+    size_t strings_capacity;
+};
+
+/**
+ * Writes the tokens of the context's source onto the tape.
+ */
+struct jsn_tape_builder {
+    struct jsn_parse_context context;
+    struct jsn_tape *tape;
+};
+
+static inline uint64_t jsn_tape_entry(enum jsn_tape_tag tag,
+                                      uint64_t payload) {
+    return (uint64_t)tag << 56 | payload;
+}
+
+static inline enum jsn_tape_tag jsn_tape_tag_of(uint64_t entry) {
+    return (enum jsn_tape_tag)(entry >> 56);
+}
+
+static inline size_t jsn_tape_push(struct jsn_tape *tape, uint64_t entry) {
+    if (tape->count == tape->capacity) {
+        size_t capacity = tape->capacity * 2;
+        uint64_t *entries =
+            jsn_realloc(tape->entries, sizeof(uint64_t) * capacity);
+
+        // Check allocation success.
+        if (entries == NULL) {
+            jsn_report_failure("Memory allocation failure.");
+            return 0;
+        }
+
+        tape->entries = entries;
+        tape->capacity = capacity;
+    }
+
+    tape->entries[tape->count] = entry;
+    return tape->count++;
+}
+
+void jsn_tape_push_string(struct jsn_tape *tape, const char *string,
+                          uint32_t length) {
+    size_t size = sizeof(uint32_t) + length + 1;
+
+    if (tape->strings_length + size > tape->strings_capacity) {
+        size_t capacity = tape->strings_capacity * 2;
+        while (tape->strings_length + size > capacity) {
+            capacity *= 2;
+        }
+
+        char *strings = jsn_realloc(tape->strings, capacity);
+
+        // Check allocation success.
+        if (strings == NULL) {
+            jsn_report_failure("Memory allocation failure.");
+            return;
+        }
+
+        tape->strings = strings;
+        tape->strings_capacity = capacity;
+    }
+
+    char *destination = &tape->strings[tape->strings_length];
+    memcpy(destination, &length, sizeof(uint32_t));
+    memcpy(destination + sizeof(uint32_t), string, length);
+    destination[sizeof(uint32_t) + length] = '\0';
+
+    jsn_tape_push(tape, jsn_tape_entry(JSN_TAPE_STRING, tape->strings_length));
+    tape->strings_length += size;
+}
+
+/**
+ * Ends the array or object that starts at the given entry.
+ */
+void jsn_tape_push_end(struct jsn_tape *tape, size_t start, size_t count) {
+    size_t end = tape->count;
+
+    if (end > UINT32_MAX) {
+        jsn_report_failure("The document is too large.");
+    }
+
+    if (count > JSN_TAPE_COUNT_MAX) {
+        count = JSN_TAPE_COUNT_MAX;
+    }
+
+    tape->entries[start] |= (uint64_t)count << 32 | end;
+    jsn_tape_push(tape, jsn_tape_entry(JSN_TAPE_END, start));
+}
+
+bool jsn_tape_parse_value(struct jsn_tape_builder *builder,
+                          struct jsn_token token);
+
+void jsn_tape_parse_array(struct jsn_tape_builder *builder,
+                          struct jsn_token token) {
+    struct jsn_tape *tape = builder->tape;
+    size_t start = jsn_tape_push(tape, jsn_tape_entry(JSN_TAPE_ARRAY, 0));
+    size_t count = 0;
+
+    // Commas and the closing bracket are skipped by the value parser.
+    while (token.type != JSN_TOC_ARRAY_CLOSE) {
+        token = jsn_parse_next_token(&builder->context);
+        if (jsn_tape_parse_value(builder, token)) {
+            count++;
+        }
+    }
+
+    jsn_tape_push_end(tape, start, count);
+}
+
+void jsn_tape_parse_object(struct jsn_tape_builder *builder,
+                           struct jsn_token token) {
+    struct jsn_tape *tape = builder->tape;
+    size_t start = jsn_tape_push(tape, jsn_tape_entry(JSN_TAPE_OBJECT, 0));
+    size_t count = 0;
+    struct jsn_token token_key, token_colon;
+
+    // While we haven't reached the end of the object.
+    while (token.type != JSN_TOC_OBJECT_CLOSE) {
+        token_key = jsn_parse_next_token(&builder->context);
+
+        // It's an empty token, just break and move on.
+        if (token_key.type == JSN_TOC_OBJECT_CLOSE) {
+            break;
+        }
+
+        if (token_key.type != JSN_TOC_STRING) {
+            jsn_report_failure("Unknown token found!");
+            return;
+        }
+
+        token_colon = jsn_parse_next_token(&builder->context);
+        if (token_colon.type != JSN_TOC_COLON) {
+            jsn_report_failure("Unknown token found!");
+            return;
+        }
+
+        jsn_tape_push_string(tape, token_key.lexeme_start,
+                             token_key.lexeme_length);
+
+        // Every key needs a value.
+        if (!jsn_tape_parse_value(builder,
+                                  jsn_parse_next_token(&builder->context))) {
+            jsn_report_failure("Unknown token found!");
+            return;
+        }
+        count++;
+
+        // Either a comma or the end of the object.
+        token = jsn_parse_next_token(&builder->context);
+    }
+
+    jsn_tape_push_end(tape, start, count);
+}
+
+/**
+ * Writes the value that starts with the given token onto the tape. Returns
+ * false when the token isn't the start of a value.
+ */
+bool jsn_tape_parse_value(struct jsn_tape_builder *builder,
+                          struct jsn_token token) {
+    struct jsn_tape *tape = builder->tape;
+
+    switch (token.type) {
+    case JSN_TOC_OBJECT_OPEN:
+        jsn_tape_parse_object(builder, token);
+        return true;
+    case JSN_TOC_ARRAY_OPEN:
+        jsn_tape_parse_array(builder, token);
+        return true;
+    case JSN_TOC_STRING:
+        jsn_tape_push_string(tape, token.lexeme_start, token.lexeme_length);
+        return true;
+    case JSN_TOC_INTEGER: {
+        int value =
+            jsn_parse_integer_span(token.lexeme_start, token.lexeme_length);
+        jsn_tape_push(tape, jsn_tape_entry(JSN_TAPE_INTEGER, (uint32_t)value));
+        return true;
+    }
+    case JSN_TOC_DOUBLE: {
+        double value =
+            jsn_parse_number_span(token.lexeme_start, token.lexeme_length);
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        jsn_tape_push(tape, jsn_tape_entry(JSN_TAPE_DOUBLE, 0));
+        jsn_tape_push(tape, bits);
+        return true;
+    }
+    case JSN_TOC_BOOLEAN:
+        jsn_tape_push(tape, jsn_tape_entry(token.lexeme_start[0] == 't'
+                                               ? JSN_TAPE_TRUE
+                                               : JSN_TAPE_FALSE,
+                                           0));
+        return true;
+    case JSN_TOC_NULL:
+        jsn_tape_push(tape, jsn_tape_entry(JSN_TAPE_NULL, 0));
+        return true;
+    case JSN_TOC_ARRAY_CLOSE:
+    case JSN_TOC_OBJECT_CLOSE:
+    case JSN_TOC_COMMA:
+        return false;
+    default:
+        jsn_report_failure("Unknown token found!");
+        return false;
+    }
+}
+
+struct jsn_tape *jsn_tape_parse_source(char *source, size_t source_length) {
+    struct jsn_tape *tape = jsn_malloc(sizeof(struct jsn_tape));
+
+    // Check allocation success.
+    if (tape == NULL) {
+        jsn_report_failure("Memory allocation failure.");
+        return NULL;
+    }
+
+    // Values take up a few bytes of source at least, so the tape rarely
+    // needs to grow more than once or twice.
+    tape->count = 0;
+    tape->capacity = source_length / 8 + 16;
+    tape->entries = jsn_malloc(sizeof(uint64_t) * tape->capacity);
+    tape->strings_length = 0;
+    tape->strings_capacity = source_length / 4 + 64;
+    tape->strings = jsn_malloc(tape->strings_capacity);
+
+    if (tape->entries == NULL || tape->strings == NULL) {
+        jsn_report_failure("Memory allocation failure.");
+        return NULL;
+    }
+
+    struct jsn_tape_builder builder;
+    builder.tape = tape;
+    jsn_parse_context_init_tokens(&builder.context, source, source_length);
+
+    if (!jsn_tape_parse_value(&builder,
+                              jsn_parse_next_token(&builder.context))) {
+        jsn_report_failure("File could not be parsed!");
+        return NULL;
+    }
+
+    jsn_parse_context_free(&builder.context);
+
+    return tape;
+}
+
+/**
+ * Returns the index of the entry after the value at the given index.
+ */
+static inline size_t jsn_tape_next(const struct jsn_tape *tape, size_t index) {
+    uint64_t entry = tape->entries[index];
+
+    switch (jsn_tape_tag_of(entry)) {
+    case JSN_TAPE_ARRAY:
+    case JSN_TAPE_OBJECT:
+        return (uint32_t)entry + 1;
+    case JSN_TAPE_DOUBLE:
+        return index + 2;
+    default:
+        return index + 1;
+    }
+}
+
+/**
+ * Returns the string of the entry at the given index, and stores it's length.
+ */
+static inline const char *jsn_tape_string(const struct jsn_tape *tape,
+                                          size_t index, uint32_t *length) {
+    const char *string =
+        &tape->strings[tape->entries[index] & JSN_TAPE_PAYLOAD_MASK];
+    memcpy(length, string, sizeof(uint32_t));
+    return string + sizeof(uint32_t);
+}
+
+/**
+ * Returns the number of items of the array or object at the given index.
+ */
+size_t jsn_tape_count(const struct jsn_tape *tape, size_t index) {
+    uint64_t entry = tape->entries[index];
+    size_t count = (entry & JSN_TAPE_PAYLOAD_MASK) >> 32;
+
+    if (count < JSN_TAPE_COUNT_MAX) {
+        return count;
+    }
+
+    // The count didn't fit, so count the items one by one.
+    bool object = jsn_tape_tag_of(entry) == JSN_TAPE_OBJECT;
+    size_t end = (uint32_t)entry;
+    count = 0;
+
+    for (size_t i = index + 1; i < end; i = jsn_tape_next(tape, i)) {
+        if (object) {
+            i++;
+        }
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * Returns the index of the object's first value with the given key, or zero
+ * when no such value exists. The root is never a value of an object.
+ */
+size_t jsn_tape_find_key(const struct jsn_tape *tape, size_t index,
+                         const char *key) {
+    uint64_t entry = tape->entries[index];
+
+    if (jsn_tape_tag_of(entry) != JSN_TAPE_OBJECT) {
+        return 0;
+    }
+
+    size_t key_length = strlen(key);
+    size_t end = (uint32_t)entry;
+
+    for (size_t i = index + 1; i < end; i = jsn_tape_next(tape, i + 1)) {
+        uint32_t length;
+        const char *string = jsn_tape_string(tape, i, &length);
+
+        if (length == key_length && memcmp(string, key, length) == 0) {
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Creates the node of the value at the given index, allocated and with it's
+ * keys interned through the given context.
+ */
+struct jsn_node *jsn_tape_read_node(struct jsn_parse_context *context,
+                                    const struct jsn_tape *tape,
+                                    size_t index) {
+    struct jsn_arena *arena = context->arena;
+    uint64_t entry = tape->entries[index];
+    struct jsn_node *node;
+
+    switch (jsn_tape_tag_of(entry)) {
+    case JSN_TAPE_INTEGER:
+        node = jsn_create_node(arena, JSN_NODE_INTEGER);
+        node->value.value_integer = (int)(uint32_t)entry;
+        return node;
+    case JSN_TAPE_DOUBLE:
+        node = jsn_create_node(arena, JSN_NODE_DOUBLE);
+        memcpy(&node->value.value_double, &tape->entries[index + 1],
+               sizeof(double));
+        return node;
+    case JSN_TAPE_FALSE:
+    case JSN_TAPE_TRUE:
+        node = jsn_create_node(arena, JSN_NODE_BOOLEAN);
+        node->value.value_boolean = jsn_tape_tag_of(entry) == JSN_TAPE_TRUE;
+        return node;
+    case JSN_TAPE_STRING: {
+        uint32_t length;
+        const char *string = jsn_tape_string(tape, index, &length);
+        node = jsn_create_node(arena, JSN_NODE_STRING);
+        jsn_set_node_string(node, string, length);
+        return node;
+    }
+    case JSN_TAPE_ARRAY:
+    case JSN_TAPE_OBJECT: {
+        bool object = jsn_tape_tag_of(entry) == JSN_TAPE_OBJECT;
+        size_t count = jsn_tape_count(tape, index);
+
+        node = jsn_create_node(arena,
+                               object ? JSN_NODE_OBJECT : JSN_NODE_ARRAY);
+        if (count == 0) {
+            return node;
+        }
+
+        // The count is known up front, so the children are read straight
+        // into an exact sized array.
+        node->children = jsn_alloc(arena, sizeof(struct jsn_node *) * count);
+        node->children_capacity = (unsigned int)count;
+
+        size_t end = (uint32_t)entry;
+        for (size_t i = index + 1; i < end; i = jsn_tape_next(tape, i)) {
+            uint32_t length = 0;
+            const char *key = NULL;
+            if (object) {
+                key = jsn_tape_string(tape, i++, &length);
+            }
+
+            struct jsn_node *child = jsn_tape_read_node(context, tape, i);
+            if (object) {
+                jsn_parse_intern_key(context, child, key, length);
+            }
+
+            node->children[node->children_count++] = child;
+        }
+
+        jsn_key_index_prepare(node);
+        return node;
+    }
+    default:
+        return jsn_create_node(arena, JSN_NODE_NULL);
+    }
+}
+
+/* CURSOR:
+ * --------------------------------------------------------------------------*/
+
+/*
+ * Cursors read values straight from the source, on demand. Values that are
+ * not asked for are skipped by matching their brackets and quotes, without
+ * creating any nodes or decoding any numbers.
+ */
+
+/**
+ * Returns a tokenizer that's positioned at the cursor's value.
+ */
+static inline struct jsn_tokenizer
+jsn_cursor_tokenizer(struct jsn_cursor cursor) {
+    struct jsn_tokenizer tokenizer =
+        jsn_tokenizer_init((char *)cursor.source, cursor.length, false);
+    tokenizer.source_cursor = cursor.position;
+
+    return tokenizer;
+}
+
+static inline struct jsn_cursor
+jsn_cursor_at(struct jsn_cursor cursor, struct jsn_tokenizer *tokenizer) {
+    cursor.position = tokenizer->source_cursor;
+    return cursor;
+}
+
+/**
+ * Moves the tokenizer past the value that starts with the given token.
+ */
+void jsn_cursor_skip_value(struct jsn_tokenizer *tokenizer,
+                           struct jsn_token token) {
+    if (token.type != JSN_TOC_OBJECT_OPEN && token.type != JSN_TOC_ARRAY_OPEN) {
+        // Scalars have already been read by the tokenizer.
+        if (token.type == JSN_TOC_UNKNOWN || token.type == JSN_TOC_COLON) {
+            jsn_report_failure("Unknown token found!");
+        }
+        return;
+    }
+
+    const char *cursor = &tokenizer->source[tokenizer->source_cursor];
+    const char *end = &tokenizer->source[tokenizer->source_length];
+    unsigned int depth = 1;
+
+    // Only brackets and strings matter, until the closing bracket is found.
+    while (depth > 0) {
+        if (cursor >= end) {
+            jsn_report_failure("Unexpected end of JSON found!");
+            return;
+        }
+
+        switch (*cursor++) {
+        case '{':
+        case '[':
+            depth++;
+            break;
+        case '}':
+        case ']':
+            depth--;
+            break;
+        case '"':
+            // Jump from one quote or backslash to the next.
+            while (true) {
+                cursor = jsn_scan_string(cursor, end);
+
+                if (cursor == end || *cursor == '\0') {
+                    jsn_report_failure("Unterminated string found!");
+                    return;
+                }
+
+                if (*cursor++ == '"') {
+                    break;
+                }
+
+                // Skip over the escaped char.
+                if (cursor != end) {
+                    cursor++;
+                }
+            }
+            break;
+        }
+    }
+
+    tokenizer->source_cursor = cursor - tokenizer->source;
+}
+
+/**
+ * Returns a cursor to the value of the given key, the cursor must be on an
+ * object. The found flag is cleared when the object doesn't have the key.
+ */
+struct jsn_cursor jsn_cursor_find_key(struct jsn_cursor cursor,
+                                      const char *key, bool *found) {
+    struct jsn_tokenizer tokenizer = jsn_cursor_tokenizer(cursor);
+    struct jsn_token token = jsn_tokenizer_get_next_token(&tokenizer);
+    size_t key_length = strlen(key);
+
+    *found = false;
+    if (token.type != JSN_TOC_OBJECT_OPEN) {
+        return cursor;
+    }
+
+    while (true) {
+        token = jsn_tokenizer_get_next_token(&tokenizer);
+
+        if (token.type == JSN_TOC_OBJECT_CLOSE) {
+            return cursor;
+        }
+
+        if (token.type != JSN_TOC_STRING ||
+            jsn_tokenizer_get_next_token(&tokenizer).type != JSN_TOC_COLON) {
+            jsn_report_failure("Unknown token found!");
+            return cursor;
+        }
+
+        if (token.lexeme_length == key_length &&
+            memcmp(token.lexeme_start, key, key_length) == 0) {
+            *found = true;
+            return jsn_cursor_at(cursor, &tokenizer);
+        }
+
+        // Skip the value and the comma after it.
+        jsn_cursor_skip_value(&tokenizer,
+                              jsn_tokenizer_get_next_token(&tokenizer));
+
+        token = jsn_tokenizer_get_next_token(&tokenizer);
+        if (token.type == JSN_TOC_OBJECT_CLOSE) {
+            return cursor;
+        }
+
+        if (token.type != JSN_TOC_COMMA) {
+            jsn_report_failure("Unknown token found!");
+            return cursor;
+        }
+    }
+}
+
+/**
+ * Moves the tokenizer to the start of the array's next item, the first item
+ * follows the opening bracket and the others follow a comma. Returns false
+ * once the end of the array is reached.
+ */
+bool jsn_cursor_next_item(struct jsn_tokenizer *tokenizer, bool first) {
+    size_t item_start = tokenizer->source_cursor;
+    struct jsn_token token = jsn_tokenizer_get_next_token(tokenizer);
+
+    if (first == false) {
+        if (token.type == JSN_TOC_ARRAY_CLOSE) {
+            return false;
+        }
+
+        if (token.type != JSN_TOC_COMMA) {
+            jsn_report_failure("Unknown token found!");
+            return false;
+        }
+
+        item_start = tokenizer->source_cursor;
+        token = jsn_tokenizer_get_next_token(tokenizer);
+    }
+
+    if (token.type == JSN_TOC_ARRAY_CLOSE) {
+        return false;
+    }
+
+    tokenizer->source_cursor = item_start;
+    return true;
+}
+
+/**
+ * Moves the tokenizer past the array's opening bracket.
+ */
+void jsn_cursor_open_array(struct jsn_tokenizer *tokenizer) {
+    if (jsn_tokenizer_get_next_token(tokenizer).type != JSN_TOC_ARRAY_OPEN) {
+        jsn_report_failure("The given handle is not of ARRAY type.");
+    }
+}
+
+/* PROJECTION:
+ * --------------------------------------------------------------------------*/
+
+/*
+ * A projection extracts the values of a few paths from a source in a single
+ * pass. Only the values at the end of a path are parsed, the objects and
+ * arrays leading to them only keep the selected children, and everything
+ * else is skipped like a cursor does.
+ */
+
+struct jsn_projection {
+    struct jsn_parse_context context;
+    struct jsn_path *const *paths;
+    jsn_handle *values;
+    unsigned int count;
+    // The indexes of the paths that matched so far, one list per depth.
+    unsigned int *active;
+};
+
+/**
+ * Moves past the value that starts with the given token. When parsing in two
+ * stages, the structural index is walked instead of the source.
+ */
+void jsn_projection_skip(struct jsn_parse_context *context,
+                         struct jsn_token token) {
+    if (context->indexed == false || (token.type != JSN_TOC_OBJECT_OPEN &&
+                                      token.type != JSN_TOC_ARRAY_OPEN)) {
+        jsn_cursor_skip_value(&context->tokenizer, token);
+        return;
+    }
+
+    struct jsn_structural_index *index = &context->index;
+    unsigned int depth = 1;
+
+    while (depth > 0) {
+        if (index->next == index->count) {
+            jsn_report_failure("Unexpected end of JSON found!");
+            return;
+        }
+
+        switch (context->tokenizer.source[index->positions[index->next++]]) {
+        case '{':
+        case '[':
+            depth++;
+            break;
+        case '}':
+        case ']':
+            depth--;
+            break;
+        }
+    }
+}
+
+/**
+ * Reads the token that follows an array item or object member, and the token
+ * after it when it's a comma.
+ */
+static inline struct jsn_token
+jsn_projection_next_member(struct jsn_parse_context *context,
+                           enum jsn_token_kind close) {
+    struct jsn_token token = jsn_parse_next_token(context);
+
+    if (token.type == JSN_TOC_COMMA) {
+        return jsn_parse_next_token(context);
+    }
+
+    if (token.type != close) {
+        jsn_report_failure("Unknown token found!");
+    }
+
+    return token;
+}
+
+struct jsn_node *jsn_projection_value(struct jsn_projection *projection,
+                                      struct jsn_token token,
+                                      unsigned int active_count,
+                                      unsigned int depth);
+
+/**
+ * Returns an object with only the selected members, or NULL when none of the
+ * object's members are selected.
+ */
+struct jsn_node *jsn_projection_object(struct jsn_projection *projection,
+                                       unsigned int active_count,
+                                       unsigned int depth) {
+    struct jsn_parse_context *context = &projection->context;
+    unsigned int *active = &projection->active[depth * projection->count];
+    unsigned int *matched = &active[projection->count];
+    unsigned int stack_base = context->stack_count;
+    struct jsn_token token = jsn_parse_next_token(context);
+
+    while (token.type != JSN_TOC_OBJECT_CLOSE) {
+        struct jsn_token token_key = token;
+
+        if (token_key.type != JSN_TOC_STRING ||
+            jsn_parse_next_token(context).type != JSN_TOC_COLON) {
+            jsn_report_failure("Unknown token found!");
+            return NULL;
+        }
+
+        // The paths that continue with this key. They're no longer active
+        // for the rest of the object, so that the first of any duplicate keys
+        // wins, just like jsn_get_node_direct_child_index.
+        unsigned int matched_count = 0;
+        unsigned int remaining_count = 0;
+        for (unsigned int i = 0; i < active_count; i++) {
+            const struct jsn_path_segment *segment =
+                &projection->paths[active[i]]->segments[depth];
+
+            if (segment->key != NULL &&
+                segment->length == token_key.lexeme_length &&
+                memcmp(segment->key, token_key.lexeme_start,
+                       segment->length) == 0) {
+                matched[matched_count++] = active[i];
+            } else {
+                active[remaining_count++] = active[i];
+            }
+        }
+        active_count = remaining_count;
+
+        token = jsn_parse_next_token(context);
+
+        if (matched_count == 0) {
+            jsn_projection_skip(context, token);
+        } else {
+            struct jsn_node *child = jsn_projection_value(
+                projection, token, matched_count, depth + 1);
+
+            if (child != NULL) {
+                jsn_parse_intern_key(context, child, token_key.lexeme_start,
+                                     token_key.lexeme_length);
+                jsn_parse_stack_push(context, child);
+            }
+        }
+
+        token = jsn_projection_next_member(context, JSN_TOC_OBJECT_CLOSE);
+    }
+
+    if (context->stack_count == stack_base) {
+        return NULL;
+    }
+
+    struct jsn_node *node = jsn_create_node(context->arena, JSN_NODE_OBJECT);
+    jsn_parse_stack_commit(context, node, stack_base);
+
+    return node;
+}
+
+/**
+ * Returns an array with only the selected items, or NULL when none of the
+ * array's items are selected. The items after the last selected one are
+ * skipped all at once.
+ */
+struct jsn_node *jsn_projection_array(struct jsn_projection *projection,
+                                      unsigned int active_count,
+                                      unsigned int depth) {
+    struct jsn_parse_context *context = &projection->context;
+    unsigned int *active = &projection->active[depth * projection->count];
+    unsigned int *matched = &active[projection->count];
+    unsigned int stack_base = context->stack_count;
+
+    // One past the last selected index.
+    unsigned int end = 0;
+    for (unsigned int i = 0; i < active_count; i++) {
+        const struct jsn_path_segment *segment =
+            &projection->paths[active[i]]->segments[depth];
+
+        if (segment->key == NULL && segment->index >= end) {
+            end = segment->index + 1;
+        }
+    }
+
+    struct jsn_token token = jsn_parse_next_token(context);
+
+    for (unsigned int item = 0;
+         item < end && token.type != JSN_TOC_ARRAY_CLOSE; item++) {
+        // The paths that continue with this item.
+        unsigned int matched_count = 0;
+        for (unsigned int i = 0; i < active_count; i++) {
+            const struct jsn_path_segment *segment =
+                &projection->paths[active[i]]->segments[depth];
+
+            if (segment->key == NULL && segment->index == item) {
+                matched[matched_count++] = active[i];
+            }
+        }
+
+        if (matched_count == 0) {
+            jsn_projection_skip(context, token);
+        } else {
+            struct jsn_node *child = jsn_projection_value(
+                projection, token, matched_count, depth + 1);
+
+            if (child != NULL) {
+                jsn_parse_stack_push(context, child);
+            }
+        }
+
+        token = jsn_projection_next_member(context, JSN_TOC_ARRAY_CLOSE);
+    }
+
+    // Skip the current item, and then the rest of the array.
+    if (token.type != JSN_TOC_ARRAY_CLOSE) {
+        jsn_projection_skip(context, token);
+        token.type = JSN_TOC_ARRAY_OPEN;
+        jsn_projection_skip(context, token);
+    }
+
+    if (context->stack_count == stack_base) {
+        return NULL;
+    }
+
+    struct jsn_node *node = jsn_create_node(context->arena, JSN_NODE_ARRAY);
+    jsn_parse_stack_commit(context, node, stack_base);
+
+    return node;
+}
+
+/**
+ * Returns the selected parts of the value that starts with the given token,
+ * or NULL when nothing of it is selected. The active paths all matched the
+ * value's path up to the given depth.
+ */
+struct jsn_node *jsn_projection_value(struct jsn_projection *projection,
+                                      struct jsn_token token,
+                                      unsigned int active_count,
+                                      unsigned int depth) {
+    unsigned int *active = &projection->active[depth * projection->count];
+
+    // A path ends at this value, so all of it is parsed. Longer paths that
+    // pass through it are followed inside of the parsed value.
+    for (unsigned int i = 0; i < active_count; i++) {
+        if (projection->paths[active[i]]->count != depth) {
+            continue;
+        }
+
+        struct jsn_node *node = jsn_parse_value(&projection->context, token);
+        for (unsigned int j = 0; j < active_count; j++) {
+            projection->values[active[j]] =
+                jsn_path_follow(projection->paths[active[j]], depth, node);
+        }
+
+        return node;
+    }
+
+    switch (token.type) {
+    case JSN_TOC_OBJECT_OPEN:
+        return jsn_projection_object(projection, active_count, depth);
+    case JSN_TOC_ARRAY_OPEN:
+        return jsn_projection_array(projection, active_count, depth);
+    default:
+        jsn_projection_skip(&projection->context, token);
+        return NULL;
+    }
+}
+
+/* INCREMENTAL PARSER:
+ * --------------------------------------------------------------------------*/
+
+/*
+ * The incremental parser is fed the source in chunks and builds the same tree
+ * as the recursive parser. It keeps the containers that are still open on an
+ * explicit stack, so that it can stop at the end of any chunk and resume with
+ * the next one. Only tokens that are split across chunks get buffered.
+ */
+
+enum jsn_parser_state {
+    // Expecting a value.
+    JSN_PARSER_VALUE,
+    // After an array's opening bracket, expecting a value or the closing one.
+    JSN_PARSER_FIRST_VALUE,
+    // After an object's opening brace, expecting a key or the closing one.
+    JSN_PARSER_FIRST_KEY,
+    // After a comma inside of an object, expecting a key.
+    JSN_PARSER_KEY,
+    // After a key, expecting a colon.
+    JSN_PARSER_COLON,
+    // After a container's value, expecting a comma or it's closing character.
+    JSN_PARSER_NEXT,
+    // The root value is complete.
+    JSN_PARSER_DONE,
+};
+
+enum jsn_parser_lexeme {
+    JSN_PARSER_LEXEME_NONE,
+    JSN_PARSER_LEXEME_STRING,
+    JSN_PARSER_LEXEME_NUMBER,
+    JSN_PARSER_LEXEME_LITERAL,
+};
+
+struct jsn_parser_buffer {
+    char *data;
+    size_t length;
+    size_t capacity;
+};
+
+struct jsn_parser_frame {
+    struct jsn_node *node;
+    // Where the container's children start on the context's scratch stack.
+    unsigned int stack_base;
+};
+
+struct jsn_parser {
+    struct jsn_parse_context context;
+    enum jsn_parser_state state;
+    // The token that continues in the next chunk, if any.
+    enum jsn_parser_lexeme lexeme;
+    // The previous chunk ended in the middle of an escape sequence.
+    bool escaped;
+    // The characters of the token that continues in the next chunk.
+    struct jsn_parser_buffer pending;
+    // The key of the object member that's being parsed.
+    struct jsn_parser_buffer key;
+    bool has_key;
+    // The containers that are still open, the innermost one is last.
+    struct jsn_parser_frame *frames;
+    unsigned int frames_count;
+    unsigned int frames_capacity;
+    struct jsn_node *root;
+};
+
+void jsn_parser_buffer_append(struct jsn_parser_buffer *buffer,
+                              const char *data, size_t length) {
+    // Empty keys still need a buffer to point to.
+    if (buffer->data == NULL || buffer->length + length > buffer->capacity) {
+        size_t capacity = buffer->capacity == 0 ? 64 : buffer->capacity * 2;
+        while (capacity < buffer->length + length) {
+            capacity *= 2;
+        }
+
+        buffer->data = jsn_realloc(buffer->data, capacity);
+        buffer->capacity = capacity;
+
+        // Check allocation success.
+        if (buffer->data == NULL) {
+            jsn_report_failure("Memory allocation failure.");
+        }
+    }
+
+    memcpy(&buffer->data[buffer->length], data, length);
+    buffer->length += length;
+}
+
+/**
+ * Gives the node the key of the object member that's being parsed.
+ */
+void jsn_parser_begin_value(struct jsn_parser *parser, struct jsn_node *node) {
+    if (parser->has_key) {
+        jsn_parse_intern_key(&parser->context, node, parser->key.data,
+                             parser->key.length);
+        parser->has_key = false;
+    }
+}
+
+/**
+ * Adds the completed node to the innermost open container, or makes it the
+ * root node.
+ */
+void jsn_parser_end_value(struct jsn_parser *parser, struct jsn_node *node) {
+    if (parser->frames_count == 0) {
+        parser->root = node;
+        parser->state = JSN_PARSER_DONE;
+        return;
+    }
+
+    jsn_parse_stack_push(&parser->context, node);
+    parser->state = JSN_PARSER_NEXT;
+}
+
+void jsn_parser_open(struct jsn_parser *parser, enum jsn_node_type type) {
+    if (parser->state != JSN_PARSER_VALUE &&
+        parser->state != JSN_PARSER_FIRST_VALUE) {
+        jsn_report_failure("Unknown token found!");
+    }
+
+    struct jsn_node *node = jsn_create_node(parser->context.arena, type);
+    jsn_parser_begin_value(parser, node);
+
+    if (parser->frames_count == parser->frames_capacity) {
+        parser->frames_capacity =
+            parser->frames_capacity == 0 ? 16 : parser->frames_capacity * 2;
+        parser->frames = jsn_realloc(
+            parser->frames,
+            sizeof(struct jsn_parser_frame) * parser->frames_capacity);
+
+        // Check allocation success.
+        if (parser->frames == NULL) {
+            jsn_report_failure("Memory allocation failure.");
+        }
+    }
+
+    struct jsn_parser_frame *frame = &parser->frames[parser->frames_count++];
+    frame->node = node;
+    frame->stack_base = parser->context.stack_count;
+
+    parser->state = type == JSN_NODE_OBJECT ? JSN_PARSER_FIRST_KEY
+                                            : JSN_PARSER_FIRST_VALUE;
+}
+
+void jsn_parser_close(struct jsn_parser *parser, enum jsn_node_type type) {
+    enum jsn_parser_state empty =
+        type == JSN_NODE_OBJECT ? JSN_PARSER_FIRST_KEY : JSN_PARSER_FIRST_VALUE;
+
+    if (parser->frames_count == 0 ||
+        parser->frames[parser->frames_count - 1].node->type != type ||
+        (parser->state != JSN_PARSER_NEXT && parser->state != empty)) {
+        jsn_report_failure("Unknown token found!");
+    }
+
+    struct jsn_parser_frame frame = parser->frames[--parser->frames_count];
+    jsn_parse_stack_commit(&parser->context, frame.node, frame.stack_base);
+    jsn_parser_end_value(parser, frame.node);
+}
+
+void jsn_parser_comma(struct jsn_parser *parser) {
+    if (parser->state != JSN_PARSER_NEXT) {
+        jsn_report_failure("Unknown token found!");
+    }
+
+    struct jsn_node *container = parser->frames[parser->frames_count - 1].node;
+    parser->state = container->type == JSN_NODE_OBJECT ? JSN_PARSER_KEY
+                                                       : JSN_PARSER_VALUE;
+}
+
+/**
+ * Handles a complete string, number or literal token.
+ */
+void jsn_parser_token(struct jsn_parser *parser, struct jsn_token token) {
+    switch (parser->state) {
+    case JSN_PARSER_FIRST_KEY:
+    case JSN_PARSER_KEY:
+        if (token.type != JSN_TOC_STRING) {
+            jsn_report_failure("Unknown token found!");
+        }
+
+        parser->key.length = 0;
+        jsn_parser_buffer_append(&parser->key, token.lexeme_start,
+                                 token.lexeme_length);
+        parser->has_key = true;
+        parser->state = JSN_PARSER_COLON;
+        return;
+    case JSN_PARSER_VALUE:
+    case JSN_PARSER_FIRST_VALUE: {
+        struct jsn_node *node = jsn_parse_value(&parser->context, token);
+        jsn_parser_begin_value(parser, node);
+        jsn_parser_end_value(parser, node);
+        return;
+    }
+    default:
+        jsn_report_failure("Unknown token found!");
+    }
+}
+
+static inline bool jsn_parser_is_number_char(char current, char previous) {
+    return isdigit(current) || current == '.' || current == 'e' ||
+           current == 'E' ||
+           ((current == '-' || current == '+') &&
+            (previous == 'e' || previous == 'E'));
+}
+
+/**
+ * Creates the token for a complete lexeme.
+ */
+struct jsn_token jsn_parser_lexeme_token(enum jsn_parser_lexeme lexeme,
+                                         char *start, size_t length) {
+    struct jsn_token token;
+    token.lexeme_start = start;
+    token.lexeme_length = length;
+
+    if (lexeme == JSN_PARSER_LEXEME_STRING) {
+        token.type = JSN_TOC_STRING;
+    } else if (lexeme == JSN_PARSER_LEXEME_NUMBER) {
+        token.type = JSN_TOC_INTEGER;
+        for (size_t i = 0; i < length; i++) {
+            if (start[i] == '.' || start[i] == 'e' || start[i] == 'E') {
+                token.type = JSN_TOC_DOUBLE;
+                break;
+            }
+        }
+    } else if (length == 4 && memcmp(start, "true", 4) == 0) {
+        token.type = JSN_TOC_BOOLEAN;
+    } else if (length == 5 && memcmp(start, "false", 5) == 0) {
+        token.type = JSN_TOC_BOOLEAN;
+    } else if (length == 4 && memcmp(start, "null", 4) == 0) {
+        token.type = JSN_TOC_NULL;
+    } else {
+        jsn_report_failure("Unknown token found!");
+    }
+
+    return token;
+}
+
+/**
+ * Returns the offset of the end of the lexeme that continues at the given
+ * offset, or the chunk's length if it continues in the next chunk. The end of
+ * a string is it's closing quote.
+ */
+size_t jsn_parser_scan_lexeme(struct jsn_parser *parser,
+                              enum jsn_parser_lexeme lexeme, const char *chunk,
+                              size_t offset, size_t length) {
+    const char *cursor = &chunk[offset];
+    const char *end = &chunk[length];
+
+    if (lexeme == JSN_PARSER_LEXEME_STRING) {
+        // The escaped char of an escape sequence split across chunks.
+        if (parser->escaped && cursor != end) {
+            parser->escaped = false;
+            cursor++;
+        }
+
+        while (true) {
+            cursor = jsn_scan_string(cursor, end);
+
+            if (cursor == end) {
+                return length;
+            }
+
+            if (*cursor == '"') {
+                return cursor - chunk;
+            }
+
+            if (*cursor == '\0') {
+                jsn_report_failure("Unterminated string found!");
+            }
+
+            // Skip over the backslash and the escaped char.
+            cursor++;
+            if (cursor == end) {
+                parser->escaped = true;
+                return length;
+            }
+            cursor++;
+        }
+    }
+
+    if (lexeme == JSN_PARSER_LEXEME_NUMBER) {
+        char previous = offset > 0
+                            ? chunk[offset - 1]
+                            : parser->pending.data[parser->pending.length - 1];
+
+        while (cursor != end && jsn_parser_is_number_char(*cursor, previous)) {
+            previous = *cursor;
+            cursor++;
+        }
+
+        return cursor - chunk;
+    }
+
+    // Literals end at the first character that's not a letter.
+    while (cursor != end && isalpha(*cursor)) {
+        cursor++;
+    }
+
+    return cursor - chunk;
+}
+
+/**
+ * Reads the lexeme that starts (or continues) at the given offset, and
+ * returns the offset just past it.
+ */
+size_t jsn_parser_read_lexeme(struct jsn_parser *parser,
+                              enum jsn_parser_lexeme lexeme, const char *chunk,
+                              size_t offset, size_t length) {
+    // The first character of a number, a digit or it's sign, is already known.
+    size_t scan_offset = offset;
+    if (lexeme == JSN_PARSER_LEXEME_NUMBER && parser->pending.length == 0) {
+        scan_offset++;
+    }
+
+    size_t lexeme_end =
+        jsn_parser_scan_lexeme(parser, lexeme, chunk, scan_offset, length);
+
+    // The lexeme continues in the next chunk.
+    if (lexeme_end == length) {
+        jsn_parser_buffer_append(&parser->pending, &chunk[offset],
+                                 length - offset);
+        parser->lexeme = lexeme;
+        return length;
+    }
+
+    // Strings skip over their closing quote.
+    size_t next = lexeme == JSN_PARSER_LEXEME_STRING ? lexeme_end + 1
+                                                     : lexeme_end;
+
+    if (parser->pending.length == 0) {
+        // Complete lexemes are used straight from the chunk.
+        jsn_parser_token(parser,
+                         jsn_parser_lexeme_token(lexeme, (char *)&chunk[offset],
+                                                 lexeme_end - offset));
+    } else {
+        jsn_parser_buffer_append(&parser->pending, &chunk[offset],
+                                 lexeme_end - offset);
+        jsn_parser_token(parser,
+                         jsn_parser_lexeme_token(lexeme, parser->pending.data,
+                                                 parser->pending.length));
+        parser->pending.length = 0;
+    }
+
+    parser->lexeme = JSN_PARSER_LEXEME_NONE;
+    return next;
+}
+
+void jsn_parser_consume(struct jsn_parser *parser, const char *chunk,
+                        size_t length) {
+    size_t offset = 0;
+
+    // Finish the lexeme that was split across chunks first.
+    if (parser->lexeme != JSN_PARSER_LEXEME_NONE) {
+        offset =
+            jsn_parser_read_lexeme(parser, parser->lexeme, chunk, 0, length);
+    }
+
+    while (offset < length) {
+        char current = chunk[offset];
+
+        // Just skip spaces.
+        if (isspace(current)) {
+            offset++;
+            continue;
+        }
+
+        switch (current) {
+        case '{':
+            jsn_parser_open(parser, JSN_NODE_OBJECT);
+            offset++;
+            break;
+        case '[':
+            jsn_parser_open(parser, JSN_NODE_ARRAY);
+            offset++;
+            break;
+        case '}':
+            jsn_parser_close(parser, JSN_NODE_OBJECT);
+            offset++;
+            break;
+        case ']':
+            jsn_parser_close(parser, JSN_NODE_ARRAY);
+            offset++;
+            break;
+        case ',':
+            jsn_parser_comma(parser);
+            offset++;
+            break;
+        case ':':
+            if (parser->state != JSN_PARSER_COLON) {
+                jsn_report_failure("Unknown token found!");
+            }
+            parser->state = JSN_PARSER_VALUE;
+            offset++;
+            break;
+        case '"':
+            offset = jsn_parser_read_lexeme(parser, JSN_PARSER_LEXEME_STRING,
+                                            chunk, offset + 1, length);
+            break;
+        case 't':
+        case 'f':
+        case 'n':
+            offset = jsn_parser_read_lexeme(parser, JSN_PARSER_LEXEME_LITERAL,
+                                            chunk, offset, length);
+            break;
+        default:
+            if (isdigit(current) || current == '-') {
+                offset = jsn_parser_read_lexeme(
+                    parser, JSN_PARSER_LEXEME_NUMBER, chunk, offset, length);
+                break;
+            }
+
+            jsn_report_failure("Unknown token found!");
+        }
+    }
+}
+
+/* Debug:
+ * --------------------------------------------------------------------------*/
+
+void jsn_node_print_tree(struct jsn_node *node, unsigned int indent) {
+    // Generate padding string, if needed.
+    char indent_str[indent + 1];
+    for (unsigned int i = 0; i < indent; i++) {
+        indent_str[i] = '.';
+    }
+    indent_str[indent] = '\0';
+
+    // Print out the current node.
+    printf("%s[\n", indent_str);
+    printf("%sNode: \n", indent_str);
+    printf("%sKey: %s\n", indent_str, node->key);
+    switch (node->type) {
+    case JSN_NODE_NULL:
+        printf("%sType: %s\n", indent_str, "NULL");
+        printf("%sValue: %s\n", indent_str, "null");
+        break;
+    case JSN_NODE_INTEGER:
+        printf("%sType: %s\n", indent_str, "INTEGER");
+        printf("%sValue: %i\n", indent_str, node->value.value_integer);
+        break;
+    case JSN_NODE_DOUBLE:
+        printf("%sType: %s\n", indent_str, "DOUBLE");
+        printf("%sValue: %f\n", indent_str, node->value.value_double);
+        break;
+    case JSN_NODE_BOOLEAN:
+        printf("%sType: %s\n", indent_str, "BOOLEAN");
+        printf("%sValue: %i\n", indent_str, node->value.value_boolean);
+        break;
+    case JSN_NODE_STRING:
+        printf("%sType: %s\n", indent_str, "STRING");
+        printf("%sValue: %s\n", indent_str, node->value.value_string);
+        break;
+    case JSN_NODE_ARRAY:
+        printf("%sType: %s\n", indent_str, "ARRAY");
+        break;
+    case JSN_NODE_OBJECT:
+        printf("%sType: %s\n", indent_str, "OBJECT");
+        break;
+    }
+    printf("%sChildren_Count: %u\n", indent_str, node->children_count);
+
+    // Print children too.
+    for (unsigned int i = 0; i < node->children_count; i++) {
+        // Print out node children (recursive call).
+        jsn_node_print_tree(node->children[i], indent + 4);
+    }
+    printf("%s]\n", indent_str);
+}
+
+/* API:
+ * --------------------------------------------------------------------------*/
+
+void jsn_set_option(enum jsn_option option, bool enabled) {
+    if (enabled) {
+        jsn_options |= option;
+        return;
+    }
+
+    jsn_options &= ~option;
+}
+
+bool jsn_get_option(enum jsn_option option) {
+    return (jsn_options & option) != 0;
+}
+
+void jsn_set_parallel_threads(unsigned int thread_count) {
+    jsn_parallel_threads = thread_count;
+}
+
+void jsn_set_allocator(const struct jsn_allocator *allocator) {
+    if (allocator == NULL) {
+        jsn_allocator.malloc = jsn_default_malloc;
+        jsn_allocator.realloc = jsn_default_realloc;
+        jsn_allocator.free = jsn_default_free;
+        jsn_allocator.user_data = NULL;
+        return;
+    }
+
+    jsn_allocator = *allocator;
+}
+
+void jsn_count_allocations(struct jsn_allocation_stats *stats) {
+    jsn_allocation_stats = stats;
+}
+
+bool jsn_get_stats(struct jsn_stats *stats) {
+#ifdef JSN_STATS
+    *stats = jsn_stats_counters;
+    return true;
+#else
+    memset(stats, 0, sizeof(struct jsn_stats));
+    return false;
+#endif
+}
+
+void jsn_reset_stats() {
+#ifdef JSN_STATS
+    memset(&jsn_stats_counters, 0, sizeof(struct jsn_stats));
+#endif
+}
+
+void jsn_print(jsn_handle handle) { jsn_node_to_stream(handle, stdout); }
+
+char *jsn_to_buffer(jsn_handle handle, size_t *length) {
+    struct jsn_writer writer = jsn_writer_init(NULL, true);
+    jsn_write_node(&writer, handle);
+    jsn_writer_put_char(&writer, '\0');
+
+    if (length != NULL) {
+        *length = writer.length - 1;
+    }
+
+    return writer.data;
+}
+
+char *jsn_to_binary(jsn_handle handle, size_t *length) {
+    struct jsn_binary_encoder encoder;
+    encoder.writer = jsn_writer_init(NULL, true);
+    encoder.keys.slots = NULL;
+    encoder.keys.capacity = 0;
+    encoder.keys.count = 0;
+
+    jsn_writer_put(&encoder.writer, JSN_BINARY_MAGIC, JSN_BINARY_MAGIC_LENGTH);
+    jsn_writer_put_char(&encoder.writer, JSN_BINARY_VERSION);
+    jsn_write_binary_node(&encoder, handle);
+    jsn_free_memory(encoder.keys.slots);
+
+    *length = encoder.writer.length;
+    return encoder.writer.data;
+}
+
+jsn_handle jsn_from_binary(const char *buffer, size_t length) {
+    struct jsn_binary_reader reader;
+    reader.data = (const unsigned char *)buffer;
+    reader.length = length;
+    reader.position = JSN_BINARY_MAGIC_LENGTH + 1;
+    reader.keys = NULL;
+    reader.keys_count = 0;
+    reader.keys_capacity = 0;
+
+    if (length < reader.position ||
+        memcmp(buffer, JSN_BINARY_MAGIC, JSN_BINARY_MAGIC_LENGTH) != 0 ||
+        buffer[JSN_BINARY_MAGIC_LENGTH] != JSN_BINARY_VERSION) {
+        jsn_report_failure("Invalid binary data found!");
+        return NULL;
+    }
+
+    // There's nothing to tokenize, the context only provides the arena and
+    // the key interning.
+    jsn_parse_context_init_tokens(&reader.context, NULL, 0);
+    if (jsn_options & JSN_OPTION_ARENA) {
+        reader.context.arena = jsn_arena_create();
+    }
+
+    jsn_handle root_node = jsn_read_binary_node(&reader);
+
+    // The root node releases the document's arena.
+    if (reader.context.arena != NULL) {
+        reader.context.arena->owner = root_node;
+    }
+
+    jsn_parse_context_free(&reader.context);
+    jsn_free_memory(reader.keys);
+
+    return root_node;
+}
+
+/**
+ * Parses the given source into a new document.
+ */
+jsn_handle jsn_parse_source(char *source, size_t source_length, bool insitu) {
+    // Large arrays are parsed on multiple threads, when there are any.
+    if ((jsn_options & JSN_OPTION_PARALLEL) &&
+        source_length >= JSN_PARALLEL_MIN_LENGTH &&
+        jsn_thread_count(jsn_parallel_threads, SIZE_MAX) > 1) {
+        size_t start = 0;
+        while (start < source_length && isspace(source[start])) {
+            start++;
+        }
+
+        if (start < source_length && source[start] == '[') {
+            return jsn_parse_parallel(source, source_length, start, insitu);
+        }
+    }
+
+    // Create the parser's context and tokenizer from buffer.
+    struct jsn_parse_context context;
+    jsn_parse_context_init(&context, source, source_length, insitu);
+
+    // Get the first token.
+    struct jsn_token token = jsn_parse_next_token(&context);
+
+    // Start parsing, recursively.
+    jsn_handle root_node = jsn_parse_value(&context, token);
+
+    // If the parser returned NULL, return NULL.
+    if (root_node == NULL) {
+        jsn_report_failure("File could not be parsed!");
+        return NULL;
+    }
+
+    // The root node releases the document's arena.
+    if (context.arena != NULL) {
+        context.arena->owner = root_node;
+    }
+
+    context.tokenizer.source = NULL;
+    jsn_parse_context_free(&context);
+
+    return root_node;
+}
+
+jsn_handle jsn_from_file(const char *file_path) {
+    bool insitu = (jsn_options & JSN_OPTION_INSITU) != 0;
+    struct jsn_source source = jsn_source_load(file_path, insitu);
+
+    jsn_handle root_node = jsn_parse_source(source.data, source.length, insitu);
+
+    // In-situ parsed documents keep the file's contents alive.
+    if (insitu) {
+        root_node->arena->source = source;
+    } else {
+        jsn_source_release(&source);
+    }
+
+    return root_node;
+}
+
+jsn_handle jsn_from_buffer(const char *buffer, size_t length) {
+    // The source is only read, unless parsing in-situ.
+    return jsn_parse_source((char *)buffer, length, false);
+}
+
+jsn_handle jsn_from_buffer_insitu(char *buffer, size_t length) {
+    return jsn_parse_source(buffer, length, true);
+}
+
+jsn_handle *jsn_ndjson_from_buffer(const char *buffer, size_t length,
+                                   unsigned int thread_count, size_t *count) {
+    struct jsn_ndjson_job job;
+    job.callback = NULL;
+    job.user_data = NULL;
+    jsn_ndjson_run(&job, buffer, length, thread_count);
+
+    size_t total = 0;
+    for (size_t i = 0; i < job.chunk_count; i++) {
+        total += job.chunks[i].count;
+    }
+
+    jsn_handle *records = malloc(sizeof(jsn_handle) * (total + 1));
+
+    // Check allocation success.
+    if (records == NULL) {
+        jsn_report_failure("Memory allocation failure.");
+        return NULL;
+    }
+
+    // Concatenate the chunks' records, which keeps them in input order.
+    size_t offset = 0;
+    for (size_t i = 0; i < job.chunk_count; i++) {
+        struct jsn_ndjson_chunk *chunk = &job.chunks[i];
+        if (chunk->count != 0) {
+            memcpy(&records[offset], chunk->records,
+                   sizeof(jsn_handle) * chunk->count);
+            offset += chunk->count;
+        }
+        jsn_free_memory(chunk->records);
+    }
+    jsn_free_memory(job.chunks);
+
+    *count = total;
+    return records;
+}
+
+void jsn_ndjson_for_each(const char *buffer, size_t length,
+                         unsigned int thread_count,
+                         void (*callback)(void *user_data, jsn_handle record),
+                         void *user_data) {
+    struct jsn_ndjson_job job;
+    job.callback = callback;
+    job.user_data = user_data;
+    jsn_ndjson_run(&job, buffer, length, thread_count);
+    jsn_free_memory(job.chunks);
+}
+
+void jsn_ndjson_for_each_in_file(const char *file_path,
+                                 unsigned int thread_count,
+                                 void (*callback)(void *user_data,
+                                                  jsn_handle record),
+                                 void *user_data) {
+    struct jsn_source source = jsn_source_load(file_path, false);
+    jsn_ndjson_for_each(source.data, source.length, thread_count, callback,
+                        user_data);
+    jsn_source_release(&source);
+}
+
+void jsn_events_from_buffer(const char *buffer, size_t length,
+                            const struct jsn_handler *handler,
+                            void *user_data) {
+    jsn_events_parse_source((char *)buffer, length, handler, user_data);
+}
+
+void jsn_events_from_file(const char *file_path,
+                          const struct jsn_handler *handler, void *user_data) {
+    struct jsn_source source = jsn_source_load(file_path, false);
+    jsn_events_parse_source(source.data, source.length, handler, user_data);
+    jsn_source_release(&source);
+}
+
+struct jsn_cursor jsn_cursor_from_buffer(const char *buffer, size_t length) {
+    struct jsn_cursor cursor = {buffer, length, 0};
+    return cursor;
+}
+
+struct jsn_cursor jsn_cursor_get(struct jsn_cursor cursor,
+                                 unsigned int arg_count, ...) {
+    bool found = true;
+
+    // Find the value using the given keys.
+    va_list args;
+    va_start(args, arg_count);
+    for (unsigned int i = 0; i < arg_count && found; i++) {
+        cursor = jsn_cursor_find_key(cursor, va_arg(args, char *), &found);
+    }
+    va_end(args);
+
+    // fail on missing keys
+    if (found == false) {
+        jsn_report_failure("Object does not have the provided key.");
+    }
+
+    return cursor;
+}
+
+struct jsn_cursor jsn_cursor_get_array_item(struct jsn_cursor cursor,
+                                            unsigned int index) {
+    struct jsn_tokenizer tokenizer = jsn_cursor_tokenizer(cursor);
+    jsn_cursor_open_array(&tokenizer);
+
+    // Skip over the items before the requested one.
+    for (unsigned int i = 0; jsn_cursor_next_item(&tokenizer, i == 0); i++) {
+        if (i == index) {
+            return jsn_cursor_at(cursor, &tokenizer);
+        }
+
+        jsn_cursor_skip_value(&tokenizer,
+                              jsn_tokenizer_get_next_token(&tokenizer));
+    }
+
+    jsn_report_failure("The given index is larger then the array.");
+    return cursor;
+}
+
+unsigned int jsn_cursor_array_count(struct jsn_cursor cursor) {
+    struct jsn_tokenizer tokenizer = jsn_cursor_tokenizer(cursor);
+    jsn_cursor_open_array(&tokenizer);
+
+    unsigned int count = 0;
+    while (jsn_cursor_next_item(&tokenizer, count == 0)) {
+        jsn_cursor_skip_value(&tokenizer,
+                              jsn_tokenizer_get_next_token(&tokenizer));
+        count++;
+    }
+
+    return count;
+}
+
+int jsn_cursor_get_value_int(struct jsn_cursor cursor) {
+    struct jsn_tokenizer tokenizer = jsn_cursor_tokenizer(cursor);
+    struct jsn_token token = jsn_tokenizer_get_next_token(&tokenizer);
+
+    if (token.type == JSN_TOC_INTEGER) {
+        return jsn_parse_integer_span(token.lexeme_start, token.lexeme_length);
+    }
+
+    if (token.type == JSN_TOC_DOUBLE) {
+        return jsn_parse_number_span(token.lexeme_start, token.lexeme_length);
+    }
+
+    return 0;
+}
+
+bool jsn_cursor_get_value_bool(struct jsn_cursor cursor) {
+    struct jsn_tokenizer tokenizer = jsn_cursor_tokenizer(cursor);
+    struct jsn_token token = jsn_tokenizer_get_next_token(&tokenizer);
+
+    return token.type == JSN_TOC_BOOLEAN && token.lexeme_start[0] == 't';
+}
+
+double jsn_cursor_get_value_double(struct jsn_cursor cursor) {
+    struct jsn_tokenizer tokenizer = jsn_cursor_tokenizer(cursor);
+    struct jsn_token token = jsn_tokenizer_get_next_token(&tokenizer);
+
+    if (token.type == JSN_TOC_INTEGER || token.type == JSN_TOC_DOUBLE) {
+        return jsn_parse_number_span(token.lexeme_start, token.lexeme_length);
+    }
+
+    return 0;
+}
+
+const char *jsn_cursor_get_value_string(struct jsn_cursor cursor,
+                                        size_t *length) {
+    struct jsn_tokenizer tokenizer = jsn_cursor_tokenizer(cursor);
+    struct jsn_token token = jsn_tokenizer_get_next_token(&tokenizer);
+
+    if (token.type != JSN_TOC_STRING) {
+        *length = 0;
+        return NULL;
+    }
+
+    *length = token.lexeme_length;
+    return token.lexeme_start;
+}
+
+bool jsn_cursor_is_value_null(struct jsn_cursor cursor) {
+    struct jsn_tokenizer tokenizer = jsn_cursor_tokenizer(cursor);
+    return jsn_tokenizer_get_next_token(&tokenizer).type == JSN_TOC_NULL;
+}
+
+void jsn_to_snapshot(jsn_handle handle, const char *file_path) {
+    struct jsn_freezer freezer;
+    freezer.writer = jsn_writer_init(NULL, false);
+    freezer.strings.slots = NULL;
+    freezer.strings.capacity = 0;
+    freezer.strings.count = 0;
+
+    // The header and the root's record come first.
+    struct jsn_snapshot_header header;
+    memcpy(header.magic, JSN_SNAPSHOT_MAGIC, JSN_SNAPSHOT_MAGIC_LENGTH);
+    header.version = JSN_SNAPSHOT_VERSION;
+    header.byte_order = JSN_SNAPSHOT_BYTE_ORDER;
+
+    uint32_t header_offset = jsn_freezer_reserve(&freezer, sizeof(header));
+    header.root = jsn_freezer_reserve(&freezer, sizeof(struct jsn_frozen_node));
+
+    jsn_freezer_put_node(&freezer, handle, header.root);
+    jsn_free_memory(freezer.strings.slots);
+
+    // The length is only known once everything is laid out.
+    header.length = (uint32_t)freezer.writer.length;
+    memcpy(&freezer.writer.data[header_offset], &header, sizeof(header));
+
+    FILE *file_ptr = fopen(file_path, "wb");
+
+    if (file_ptr == NULL) {
+        jsn_report_failure("The file could not be opened, incorrect path?");
+        return;
+    }
+
+    // Write the whole snapshot at once.
+    freezer.writer.stream = file_ptr;
+    jsn_writer_flush(&freezer.writer);
+    jsn_writer_free(&freezer.writer);
+
+    // Buffered bytes that can't be written are only reported here.
+    if (fclose(file_ptr) != 0) {
+        jsn_report_failure("The file could not be written.");
+    }
+}
+
+struct jsn_snapshot *jsn_snapshot_open(const char *file_path) {
+    struct jsn_source source = jsn_source_load(file_path, false);
+
+    // Only the header is checked, the rest is used as is. A snapshot that
+    // was cut short is caught by its recorded length.
+    struct jsn_snapshot_header header;
+    if (source.length < sizeof(header)) {
+        jsn_report_failure("Invalid snapshot found!");
+    }
+
+    memcpy(&header, source.data, sizeof(header));
+    if (memcmp(header.magic, JSN_SNAPSHOT_MAGIC, JSN_SNAPSHOT_MAGIC_LENGTH) !=
+            0 ||
+        header.version != JSN_SNAPSHOT_VERSION ||
+        header.byte_order != JSN_SNAPSHOT_BYTE_ORDER ||
+        header.length != source.length ||
+        header.root + sizeof(struct jsn_frozen_node) > source.length) {
+        jsn_report_failure("Invalid snapshot found!");
+    }
+
+#ifdef JSN_MMAP
+    // Lookups jump around the snapshot, instead of reading it front to back.
+    if (source.mapped) {
+        madvise(source.data, source.length, MADV_RANDOM);
+    }
+#endif
+
+    struct jsn_snapshot *snapshot = jsn_malloc(sizeof(struct jsn_snapshot));
+
+    // Check allocation success.
+    if (snapshot == NULL) {
+        jsn_report_failure("Memory allocation failure.");
+        return NULL;
+    }
+
+    snapshot->source = source;
+
+    return snapshot;
+}
+
+struct jsn_frozen jsn_snapshot_root(struct jsn_snapshot *snapshot) {
+    struct jsn_snapshot_header header;
+    memcpy(&header, snapshot->source.data, sizeof(header));
+
+    struct jsn_frozen frozen = {snapshot->source.data, header.root};
+    return frozen;
+}
+
+void jsn_snapshot_close(struct jsn_snapshot *snapshot) {
+    jsn_source_release(&snapshot->source);
+    jsn_free_memory(snapshot);
+}
+
+struct jsn_frozen jsn_frozen_get(struct jsn_frozen frozen,
+                                 unsigned int arg_count, ...) {
+    va_list args;
+    va_start(args, arg_count);
+    for (unsigned int i = 0; i < arg_count; i++) {
+        int index = jsn_frozen_find_key(frozen, va_arg(args, char *));
+
+        // fail on unknown keys.
+        if (index == -1) {
+            va_end(args);
+            jsn_report_failure("Object does not have the provided key.");
+        }
+
+        frozen = jsn_frozen_child(frozen, index);
+    }
+    va_end(args);
+
+    return frozen;
+}
+
+struct jsn_frozen jsn_frozen_get_array_item(struct jsn_frozen frozen,
+                                            unsigned int index) {
+    const struct jsn_frozen_node *node = jsn_frozen_node_of(frozen);
+
+    // Make sure were dealing with an array item.
+    if (node->type != JSN_NODE_ARRAY) {
+        jsn_report_failure("The given handle is not of ARRAY type.");
+    }
+
+    // Make sure the provided index is not larger then the array itself.
+    if (index >= node->children_count) {
+        jsn_report_failure("The given index is larger then the array.");
+    }
+
+    return jsn_frozen_child(frozen, index);
+}
+
+unsigned int jsn_frozen_array_count(struct jsn_frozen frozen) {
+    const struct jsn_frozen_node *node = jsn_frozen_node_of(frozen);
+
+    // If the handle is not for an array, return zero.
+    if (node->type != JSN_NODE_ARRAY) {
+        return 0;
+    }
+
+    return node->children_count;
+}
+
+int jsn_frozen_get_value_int(struct jsn_frozen frozen) {
+    const struct jsn_frozen_node *node = jsn_frozen_node_of(frozen);
+
+    if (node->type == JSN_NODE_INTEGER) {
+        return (int)node->value.value_integer;
+    }
+
+    if (node->type == JSN_NODE_DOUBLE) {
+        return (int)node->value.value_double;
+    }
+
+    return 0;
 }
 
-struct jsn_node *jsn_parse_array(struct jsn_tokenizer *tokenizer,
-                                 struct jsn_token token) {
+bool jsn_frozen_get_value_bool(struct jsn_frozen frozen) {
+    const struct jsn_frozen_node *node = jsn_frozen_node_of(frozen);
+    return node->type == JSN_NODE_BOOLEAN && node->value.value_boolean != 0;
+}
 
-    // Create our array node type.
-    struct jsn_node *node = jsn_create_node(JSN_NODE_ARRAY);
-    struct jsn_node *child_node;
+double jsn_frozen_get_value_double(struct jsn_frozen frozen) {
+    const struct jsn_frozen_node *node = jsn_frozen_node_of(frozen);
 
-    // While we are not at the end of the array, handle array tokens.
-    while (token.type != JSN_TOC_ARRAY_CLOSE) {
-        token = jsn_tokenizer_get_next_token(tokenizer);
+    if (node->type == JSN_NODE_DOUBLE) {
+        return node->value.value_double;
+    }
 
-        // Create the new child node (recursive call).
-        child_node = jsn_parse_value(tokenizer, token);
+    if (node->type == JSN_NODE_INTEGER) {
+        return (double)node->value.value_integer;
+    }
 
-        if (child_node != NULL) {
-            jsn_append_node_child(node, child_node);
-        }
+    return 0;
+}
+
+const char *jsn_frozen_get_value_string(struct jsn_frozen frozen) {
+    const struct jsn_frozen_node *node = jsn_frozen_node_of(frozen);
+
+    if (node->type != JSN_NODE_STRING) {
+        return NULL;
     }
 
-    return node;
+    return &frozen.image[node->value.offset];
 }
 
-struct jsn_node *jsn_parse_object(struct jsn_tokenizer *tokenizer,
-                                  struct jsn_token token) {
-    // Create our object node type.
-    struct jsn_node *node = jsn_create_node(JSN_NODE_OBJECT);
+bool jsn_frozen_is_value_null(struct jsn_frozen frozen) {
+    return jsn_frozen_node_of(frozen)->type == JSN_NODE_NULL;
+}
 
-    struct jsn_token token_key, token_colon, token_val;
-    struct jsn_node *child_node;
+struct jsn_tape *jsn_tape_from_buffer(const char *buffer, size_t length) {
+    // The source is only read.
+    return jsn_tape_parse_source((char *)buffer, length);
+}
 
-    // While we haven't reached the end of the object.
-    while (token.type != JSN_TOC_OBJECT_CLOSE) {
+struct jsn_tape *jsn_tape_from_file(const char *file_path) {
+    struct jsn_source source = jsn_source_load(file_path, false);
+    struct jsn_tape *tape = jsn_tape_parse_source(source.data, source.length);
+    jsn_source_release(&source);
 
-        // Get the key.
-        token_key = jsn_tokenizer_get_next_token(tokenizer);
+    return tape;
+}
 
-        // It's an empty token, just break and move on.
-        if (token_key.type == JSN_TOC_OBJECT_CLOSE) {
-            break;
-        }
+struct jsn_tape_value jsn_tape_root(const struct jsn_tape *tape) {
+    struct jsn_tape_value value = {tape, 0};
+    return value;
+}
 
-        if (token_key.type != JSN_TOC_STRING) {
-            jsn_report_failure("Unknown token found!");
-            return NULL;
-        }
+void jsn_tape_free(struct jsn_tape *tape) {
+    jsn_free_memory(tape->entries);
+    jsn_free_memory(tape->strings);
+    jsn_free_memory(tape);
+}
 
-        // Get the colon.
-        token_colon = jsn_tokenizer_get_next_token(tokenizer);
-        if (token_colon.type != JSN_TOC_COLON) {
-            jsn_report_failure("Unknown token found!");
-            return NULL;
+struct jsn_tape_value jsn_tape_get(struct jsn_tape_value value,
+                                   unsigned int arg_count, ...) {
+    va_list args;
+    va_start(args, arg_count);
+    for (unsigned int i = 0; i < arg_count; i++) {
+        size_t index =
+            jsn_tape_find_key(value.tape, value.index, va_arg(args, char *));
+
+        // fail on unknown keys.
+        if (index == 0) {
+            va_end(args);
+            jsn_report_failure("Object does not have the provided key.");
         }
 
-        // Get the value and create the new child node (recursive call).
-        token_val = jsn_tokenizer_get_next_token(tokenizer);
-        child_node = jsn_parse_value(tokenizer, token_val);
+        value.index = index;
+    }
+    va_end(args);
 
-        // Allocate memory.
-        char *key = malloc(token_key.lexeme_length + 1);
+    return value;
+}
 
-        // Check allocation success.
-        if (key == NULL) {
-            jsn_report_failure("Memory allocation failure.");
-            return NULL;
-        }
+struct jsn_tape_value jsn_tape_get_array_item(struct jsn_tape_value value,
+                                              unsigned int index) {
+    const struct jsn_tape *tape = value.tape;
+    uint64_t entry = tape->entries[value.index];
 
-        // Copy over key.
-        child_node->key =
-            strncpy(key, token_key.lexeme_start, token_key.lexeme_length);
-        child_node->key[token_key.lexeme_length] = '\0';
+    // Make sure were dealing with an array item.
+    if (jsn_tape_tag_of(entry) != JSN_TAPE_ARRAY) {
+        jsn_report_failure("The given handle is not of ARRAY type.");
+    }
 
-        // Append the child node.
-        jsn_append_node_child(node, child_node);
+    // Jump over the items before it, stopping at the end of the array.
+    size_t end = (uint32_t)entry;
+    size_t item = value.index + 1;
+    for (unsigned int i = 0; i < index && item < end; i++) {
+        item = jsn_tape_next(tape, item);
+    }
 
-        /* Set the last token, if this token is a comma, then the next
-           token should be a string key, if not it will report errors above
-           on the next iteration. */
-        token = jsn_tokenizer_get_next_token(tokenizer);
+    // Make sure the provided index is not larger then the array itself.
+    if (item >= end) {
+        jsn_report_failure("The given index is larger then the array.");
     }
 
-    return node;
+    value.index = item;
+    return value;
 }
 
-struct jsn_node *jsn_parse_value(struct jsn_tokenizer *tokenizer,
-                                 struct jsn_token token) {
-    switch (token.type) {
-    case JSN_TOC_OBJECT_OPEN:
-        return jsn_parse_object(tokenizer, token);
-    case JSN_TOC_ARRAY_OPEN:
-        return jsn_parse_array(tokenizer, token);
-    case JSN_TOC_STRING:
-        return jsn_parse_string(tokenizer, token);
-    case JSN_TOC_INTEGER:
-        return jsn_parse_integer(tokenizer, token);
-    case JSN_TOC_DOUBLE:
-        return jsn_parse_double(tokenizer, token);
-    case JSN_TOC_BOOLEAN:
-        return jsn_parse_boolean(tokenizer, token);
-    case JSN_TOC_NULL:
-        return jsn_parse_null(tokenizer, token);
-    case JSN_TOC_ARRAY_CLOSE:
-    case JSN_TOC_OBJECT_CLOSE:
-    case JSN_TOC_COMMA:
-        return NULL;
-    default:
-        jsn_report_failure("Unknown token found!");
-        return NULL;
+unsigned int jsn_tape_array_count(struct jsn_tape_value value) {
+    // If the value is not an array, return zero.
+    if (jsn_tape_tag_of(value.tape->entries[value.index]) != JSN_TAPE_ARRAY) {
+        return 0;
     }
+
+    return (unsigned int)jsn_tape_count(value.tape, value.index);
 }
 
-/* Debug:
- * --------------------------------------------------------------------------*/
+int jsn_tape_get_value_int(struct jsn_tape_value value) {
+    const uint64_t *entry = &value.tape->entries[value.index];
 
-void jsn_node_print_tree(struct jsn_node *node, unsigned int indent) {
-    // Generate padding string, if needed.
-    char indent_str[indent + 1];
-    for (unsigned int i = 0; i < indent; i++) {
-        indent_str[i] = '.';
+    if (jsn_tape_tag_of(*entry) == JSN_TAPE_INTEGER) {
+        return (int)(uint32_t)*entry;
     }
-    indent_str[indent] = '\0';
 
-    // Print out the current node.
-    printf("%s[\n", indent_str);
-    printf("%sNode: \n", indent_str);
-    printf("%sKey: %s\n", indent_str, node->key);
-    switch (node->type) {
-    case JSN_NODE_NULL:
-        printf("%sType: %s\n", indent_str, "NULL");
-        printf("%sValue: %s\n", indent_str, "null");
-        break;
-    case JSN_NODE_INTEGER:
-        printf("%sType: %s\n", indent_str, "INTEGER");
-        printf("%sValue: %i\n", indent_str, node->value.value_integer);
-        break;
-    case JSN_NODE_DOUBLE:
-        printf("%sType: %s\n", indent_str, "DOUBLE");
-        printf("%sValue: %f\n", indent_str, node->value.value_double);
-        break;
-    case JSN_NODE_BOOLEAN:
-        printf("%sType: %s\n", indent_str, "BOOLEAN");
-        printf("%sValue: %i\n", indent_str, node->value.value_boolean);
-        break;
-    case JSN_NODE_STRING:
-        printf("%sType: %s\n", indent_str, "STRING");
-        printf("%sValue: %s\n", indent_str, node->value.value_string);
-        break;
-    case JSN_NODE_ARRAY:
-        printf("%sType: %s\n", indent_str, "ARRAY");
-        break;
-    case JSN_NODE_OBJECT:
-        printf("%sType: %s\n", indent_str, "OBJECT");
-        break;
+    if (jsn_tape_tag_of(*entry) == JSN_TAPE_DOUBLE) {
+        double number;
+        memcpy(&number, entry + 1, sizeof(double));
+        return (int)number;
     }
-    printf("%sChildren_Count: %u\n", indent_str, node->children_count);
 
-    // Print children too.
-    for (unsigned int i = 0; i < node->children_count; i++) {
-        // Print out node children (recursive call).
-        jsn_node_print_tree(node->children[i], indent + 4);
-    }
-    printf("%s]\n", indent_str);
+    return 0;
 }
 
-/* API:
- * --------------------------------------------------------------------------*/
+bool jsn_tape_get_value_bool(struct jsn_tape_value value) {
+    return jsn_tape_tag_of(value.tape->entries[value.index]) == JSN_TAPE_TRUE;
+}
 
-void jsn_print(jsn_handle handle) {
-    if (handle->key != NULL) {
-        printf("\"%s\":", handle->key);
+double jsn_tape_get_value_double(struct jsn_tape_value value) {
+    const uint64_t *entry = &value.tape->entries[value.index];
+
+    if (jsn_tape_tag_of(*entry) == JSN_TAPE_DOUBLE) {
+        double number;
+        memcpy(&number, entry + 1, sizeof(double));
+        return number;
     }
 
-    switch (handle->type) {
-    case JSN_NODE_STRING:
-        printf("\"%s\"", handle->value.value_string);
-        break;
-    case JSN_NODE_INTEGER:
-        printf("%u", handle->value.value_integer);
-        break;
-    case JSN_NODE_DOUBLE:
-        printf("%f", handle->value.value_double);
-        break;
-    case JSN_NODE_BOOLEAN: {
-        if (handle->value.value_boolean == true) {
-            printf("true");
-        } else {
-            printf("false");
-        }
-    } break;
-    case JSN_NODE_NULL:
-        printf("null");
-        break;
-    case JSN_NODE_ARRAY: {
-        printf("[");
-        for (unsigned int i = 0; i < handle->children_count; i++) {
-            jsn_print(handle->children[i]);
-            if (i != (handle->children_count - 1)) {
-                printf(",");
-            }
-        }
-        printf("]");
-    } break;
-    case JSN_NODE_OBJECT: {
-        printf("{");
-        for (unsigned int i = 0; i < handle->children_count; i++) {
-            jsn_print(handle->children[i]);
-            if (i != (handle->children_count - 1)) {
-                printf(",");
-            }
-        }
-        printf("}");
-    } break;
+    if (jsn_tape_tag_of(*entry) == JSN_TAPE_INTEGER) {
+        return (double)(int)(uint32_t)*entry;
     }
-}
 
-jsn_handle jsn_from_file(const char *file_path) {
-    // Open the file.
-    FILE *file_ptr = fopen(file_path, "r");
+    return 0;
+}
 
-    // In case the file can't be read, report and return null.
-    if (file_ptr == NULL) {
-        jsn_report_failure("The file could not be opened, incorrect path?");
+const char *jsn_tape_get_value_string(struct jsn_tape_value value) {
+    if (jsn_tape_tag_of(value.tape->entries[value.index]) != JSN_TAPE_STRING) {
         return NULL;
     }
 
-    // Let's get the size of the file in bytes.
-    fseek(file_ptr, 0, SEEK_END);
-    int file_size = ftell(file_ptr) + 1;
+    uint32_t length;
+    return jsn_tape_string(value.tape, value.index, &length);
+}
+
+bool jsn_tape_is_value_null(struct jsn_tape_value value) {
+    return jsn_tape_tag_of(value.tape->entries[value.index]) == JSN_TAPE_NULL;
+}
+
+jsn_handle jsn_tape_to_tree(struct jsn_tape_value value) {
+    // There's nothing to tokenize, the context only provides the arena and
+    // the key interning.
+    struct jsn_parse_context context;
+    jsn_parse_context_init_tokens(&context, NULL, 0);
+    if (jsn_options & JSN_OPTION_ARENA) {
+        context.arena = jsn_arena_create();
+    }
+
+    jsn_handle root_node =
+        jsn_tape_read_node(&context, value.tape, value.index);
+
+    // The root node releases the document's arena.
+    if (context.arena != NULL) {
+        context.arena->owner = root_node;
+    }
+
+    jsn_parse_context_free(&context);
 
-    // Rewind and allocate a local string.
-    fseek(file_ptr, 0, SEEK_SET);
+    return root_node;
+}
 
-    // Allocate and copy file source into a temp buffer.
-    char *file_buffer = malloc(file_size);
+struct jsn_parser *jsn_parser_new() {
+    struct jsn_parser *parser = jsn_calloc(1, sizeof(struct jsn_parser));
 
     // Check allocation success.
-    if (file_buffer == NULL) {
+    if (parser == NULL) {
         jsn_report_failure("Memory allocation failure.");
         return NULL;
     }
 
-    // Read file into buffer.
-    fread(file_buffer, file_size, 1, file_ptr);
-    file_buffer[file_size - 1] = '\0';
+    // The context's tokenizer isn't used, chunks are read by the parser.
+    jsn_parse_context_init(&parser->context, NULL, 0, false);
+    parser->state = JSN_PARSER_VALUE;
+    parser->lexeme = JSN_PARSER_LEXEME_NONE;
 
-    // Close the file steam.
-    fclose(file_ptr);
+    return parser;
+}
 
-    // Create tokenizer from buffer.
-    struct jsn_tokenizer tokenizer =
-        jsn_tokenizer_init(file_buffer, file_size, false);
+void jsn_parser_feed(struct jsn_parser *parser, const char *chunk,
+                     size_t length) {
+    jsn_parser_consume(parser, chunk, length);
+}
 
-    // Get the first token.
-    struct jsn_token token = jsn_tokenizer_get_next_token(&tokenizer);
+/**
+ * Frees the parser's own memory, but not the nodes it created.
+ */
+void jsn_parser_release(struct jsn_parser *parser) {
+    jsn_parse_context_free(&parser->context);
+    jsn_free_memory(parser->pending.data);
+    jsn_free_memory(parser->key.data);
+    jsn_free_memory(parser->frames);
+    jsn_free_memory(parser);
+}
 
-    // Start parsing, recursively.
-    jsn_handle root_node = jsn_parse_value(&tokenizer, token);
+jsn_handle jsn_parser_finish(struct jsn_parser *parser) {
+    // A number or literal at the very end of the input ends with it.
+    if (parser->lexeme == JSN_PARSER_LEXEME_STRING) {
+        jsn_report_failure("Unterminated string found!");
+    }
 
-    // If the parser returned NULL, return NULL.
-    if (root_node == NULL) {
-        jsn_report_failure("File could not be parsed!");
+    if (parser->lexeme != JSN_PARSER_LEXEME_NONE) {
+        jsn_parser_token(parser, jsn_parser_lexeme_token(
+                                     parser->lexeme, parser->pending.data,
+                                     parser->pending.length));
+    }
+
+    if (parser->state != JSN_PARSER_DONE) {
+        jsn_report_failure("Unexpected end of JSON found!");
         return NULL;
     }
 
-    // Free the tokenizer source, because the make copy flag is null.
-    free(file_buffer);
-    tokenizer.source = NULL;
+    jsn_handle root_node = parser->root;
+
+    // The root node releases the document's arena.
+    if (parser->context.arena != NULL) {
+        parser->context.arena->owner = root_node;
+    }
+
+    jsn_parser_release(parser);
 
-    // The node will be null anyway, so just return it.
     return root_node;
 }
 
+void jsn_parser_free(struct jsn_parser *parser) {
+    struct jsn_parse_context *context = &parser->context;
+
+    if (context->arena != NULL) {
+        jsn_arena_free(context->arena);
+    } else {
+        // Completed nodes are either on the scratch stack or the root, open
+        // containers don't have any children yet.
+        for (unsigned int i = 0; i < context->stack_count; i++) {
+            jsn_free_node(context->stack[i]);
+        }
+        for (unsigned int i = 0; i < parser->frames_count; i++) {
+            jsn_free_node(parser->frames[i].node);
+        }
+        if (parser->root != NULL) {
+            jsn_free_node(parser->root);
+        }
+    }
+
+    jsn_parser_release(parser);
+}
+
 void jsn_to_file(jsn_handle handle, const char *file_path) {
     // Open the file.
     FILE *file_ptr = fopen(file_path, "w");
 
+    if (file_ptr == NULL) {
+        jsn_report_failure("The file could not be opened, incorrect path?");
+        return;
+    }
+
     // Write the tree to a stream.
     jsn_node_to_stream(handle, file_ptr);
 
@@ -800,53 +7233,44 @@ void jsn_to_file(jsn_handle handle, const char *file_path) {
 }
 
 jsn_handle jsn_create_object() {
-    struct jsn_node *node = jsn_create_node(JSN_NODE_OBJECT);
+    struct jsn_node *node = jsn_create_builder_node(JSN_NODE_OBJECT);
     return node;
 }
 
 jsn_handle jsn_create_array() {
-    struct jsn_node *node = jsn_create_node(JSN_NODE_ARRAY);
+    struct jsn_node *node = jsn_create_builder_node(JSN_NODE_ARRAY);
     return node;
 }
 
 jsn_handle jsn_create_integer(int value) {
-    struct jsn_node *node = jsn_create_node(JSN_NODE_INTEGER);
+    struct jsn_node *node = jsn_create_builder_node(JSN_NODE_INTEGER);
     node->value.value_integer = value;
     return node;
 }
 
 jsn_handle jsn_create_double(double value) {
-    struct jsn_node *node = jsn_create_node(JSN_NODE_DOUBLE);
+    struct jsn_node *node = jsn_create_builder_node(JSN_NODE_DOUBLE);
     node->value.value_double = value;
     return node;
 }
 
 jsn_handle jsn_create_boolean(bool value) {
-    struct jsn_node *node = jsn_create_node(JSN_NODE_BOOLEAN);
+    struct jsn_node *node = jsn_create_builder_node(JSN_NODE_BOOLEAN);
     node->value.value_boolean = value;
     return node;
 }
 
 jsn_handle jsn_create_string(const char *value) {
-    struct jsn_node *node = jsn_create_node(JSN_NODE_STRING);
+    struct jsn_node *node = jsn_create_builder_node(JSN_NODE_STRING);
 
-    // Allocate new string.
-    char *str = malloc(strlen(value) + 1);
-
-    // Check allocation success.
-    if (str == NULL) {
-        jsn_report_failure("Memory allocation failure.");
-        return NULL;
-    }
-
-    // Copy value into allocated string.
-    node->value.value_string = strcpy(str, value);
+    // Copy value into the node, or a newly allocated string.
+    jsn_set_node_string(node, value, strlen(value));
 
     return node;
 }
 
 jsn_handle jsn_create_null() {
-    struct jsn_node *node = jsn_create_node(JSN_NODE_NULL);
+    struct jsn_node *node = jsn_create_builder_node(JSN_NODE_NULL);
     return node;
 }
 
@@ -876,6 +7300,81 @@ jsn_handle jsn_get(jsn_handle handle, unsigned int arg_count, ...) {
     return selected;
 }
 
+struct jsn_path *jsn_path_compile(const char *expression) {
+    int count = jsn_path_scan(expression, NULL);
+    if (count == -1) {
+        return NULL;
+    }
+
+    // The segments are followed by the expression's copy, that their keys
+    // point into.
+    size_t segments_size = count * sizeof(struct jsn_path_segment);
+    size_t expression_size = strlen(expression) + 1;
+    struct jsn_path *path = jsn_alloc(
+        NULL, sizeof(struct jsn_path) + segments_size + expression_size);
+    char *copy = (char *)path->segments + segments_size;
+    memcpy(copy, expression, expression_size);
+
+    path->count = count;
+    jsn_path_scan(copy, path->segments);
+
+    return path;
+}
+
+jsn_handle jsn_path_eval(const struct jsn_path *path, jsn_handle handle) {
+    return jsn_path_follow(path, 0, handle);
+}
+
+void jsn_path_free(struct jsn_path *path) { jsn_free_memory(path); }
+
+jsn_handle jsn_project(struct jsn_path *const *paths, unsigned int count,
+                       const char *buffer, size_t length, jsn_handle *values) {
+    if (count == 0) {
+        return NULL;
+    }
+
+    struct jsn_projection projection;
+    projection.paths = paths;
+    projection.values = values;
+    projection.count = count;
+
+    // All paths are active at the root, with room for a list per segment.
+    unsigned int depth = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        values[i] = NULL;
+        if (paths[i]->count > depth) {
+            depth = paths[i]->count;
+        }
+    }
+
+    projection.active =
+        jsn_alloc(NULL, sizeof(unsigned int) * count * (depth + 1));
+    for (unsigned int i = 0; i < count; i++) {
+        projection.active[i] = i;
+    }
+
+    struct jsn_parse_context *context = &projection.context;
+    jsn_parse_context_init(context, (char *)buffer, length, false);
+
+    jsn_handle root = jsn_projection_value(
+        &projection, jsn_parse_next_token(context), count, 0);
+
+    // The root node releases the document's arena.
+    if (context->arena != NULL) {
+        if (root == NULL) {
+            jsn_arena_free(context->arena);
+        } else {
+            context->arena->owner = root;
+        }
+    }
+
+    context->tokenizer.source = NULL;
+    jsn_parse_context_free(context);
+    jsn_free_memory(projection.active);
+
+    return root;
+}
+
 jsn_handle jsn_get_array_item(jsn_handle handle, unsigned int index) {
     // Make sure were dealing with an array item.
     if (handle->type != JSN_NODE_ARRAY) {
@@ -902,21 +7401,10 @@ jsn_handle jsn_object_set(jsn_handle handle, const char *key, jsn_handle node) {
     }
 
     // Already has a key so we need to free it.
-    if (node->key != NULL) {
-        free(node->key);
-        node->key = NULL;
-    }
-
-    // Allocate for the nodes new key.
-    char *str = malloc(strlen(key) + 1);
-
-    // Check allocation success.
-    if (str == NULL) {
-        jsn_report_failure("Memory allocation failure.");
-    }
+    jsn_free_node_key(node);
 
     // Copy over the new key string.
-    node->key = strcpy(str, key);
+    jsn_set_node_key(node, key, strlen(key));
 
     // Get the index of the child node with the same key if it exists.
     int matching_child_index = jsn_get_node_direct_child_index(handle, key);
@@ -929,8 +7417,10 @@ jsn_handle jsn_object_set(jsn_handle handle, const char *key, jsn_handle node) {
         // Replace the child node with the new one.
         handle->children[matching_child_index] = node;
 
+        jsn_adopt_node_child(handle, node);
+
         // Free the old node.
-        jsn_free_node(current_ref);
+        jsn_release_node_child(handle, current_ref);
     } else {
         // We should append a new node.
         jsn_append_node_child(handle, node);
@@ -946,10 +7436,7 @@ jsn_handle jsn_array_push(jsn_handle handle, jsn_handle node) {
     }
 
     // Array children nodes, must not have keys. (Not Objects).
-    if (node->key != NULL) {
-        free(node->key);
-        node->key = NULL;
-    }
+    jsn_free_node_key(node);
 
     // Append the node to the provided object.
     jsn_append_node_child(handle, node);
@@ -987,6 +7474,7 @@ bool jsn_is_value_null(jsn_handle handle) {
 void jsn_set_as_object(jsn_handle handle) {
     // Free the node's members.
     jsn_free_node_members(handle, true);
+    jsn_clear_node_inline_data(handle);
 
     // Set the node's new type
     handle->type = JSN_NODE_OBJECT;
@@ -995,6 +7483,7 @@ void jsn_set_as_object(jsn_handle handle) {
 void jsn_set_as_array(jsn_handle handle) {
     // Free the node's members.
     jsn_free_node_members(handle, true);
+    jsn_clear_node_inline_data(handle);
 
     // Set the node's new type
     handle->type = JSN_NODE_ARRAY;
@@ -1033,19 +7522,7 @@ void jsn_set_as_string(jsn_handle handle, const char *value) {
 
     // Set the node's new type and value.
     handle->type = JSN_NODE_STRING;
-    unsigned long str_len = strlen(value) + 1;
-
-    // Allocate for new string.
-    char *str = malloc(str_len);
-
-    // Check allocation success.
-    if (str == NULL) {
-        jsn_report_failure("Memory allocation failure.");
-        return;
-    }
-
-    // Copy over the value.
-    handle->value.value_string = strcpy(str, value);
+    jsn_set_node_string(handle, value, strlen(value));
 }
 
 void jsn_free(jsn_handle handle) { jsn_free_node(handle); }
@@ -10,6 +10,7 @@
  **/
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /* HANDLE DEFINITION.
  * ------------------------------------------------------------------------- */
@@ -20,6 +21,163 @@
  */
 typedef struct jsn_node *jsn_handle;
 
+/* OPTIONS
+ * ------------------------------------------------------------------------- */
+
+/**
+ * Global options that change how documents are parsed and created. Options
+ * only affect documents that are parsed or created after they are set.
+ */
+enum jsn_option {
+    /**
+     * Nodes, keys and strings are allocated from large per-document memory
+     * blocks (an arena), calling jsn_free on the root node releases the whole
+     * document at once. The jsn_create_* functions allocate from the document
+     * currently being built, which ends when it's root node is freed, so only
+     * build one document at a time while this option is enabled.
+     */
+    JSN_OPTION_ARENA = 1 << 0,
+
+    /**
+     * Disables the SIMD (SSE2/AVX2) kernels and only uses scalar code. This
+     * is mostly useful for testing and benchmarking.
+     */
+    JSN_OPTION_SCALAR = 1 << 1,
+
+    /**
+     * Parses in two stages. The first stage indexes all structural characters
+     * of the source in one vectorized pass, the second stage walks that index
+     * to build the tree. Mostly benefits large documents.
+     */
+    JSN_OPTION_STRUCTURAL_INDEX = 1 << 2,
+
+    /**
+     * Files are parsed in place, the document keeps the file's contents and
+     * it's keys and strings point straight into them instead of being copied.
+     * In-situ parsed documents always use an arena.
+     */
+    JSN_OPTION_INSITU = 1 << 3,
+
+    /**
+     * Large documents with an array root are parsed on multiple threads, one
+     * per core unless set with jsn_set_parallel_threads. The array is split
+     * into ranges of items that are parsed at the same time. Smaller
+     * documents are parsed on the calling thread.
+     */
+    JSN_OPTION_PARALLEL = 1 << 4,
+};
+
+/**
+ * Enables or disables the given option.
+ */
+void jsn_set_option(enum jsn_option option, bool enabled);
+
+/**
+ * Returns true if the given option is enabled.
+ */
+bool jsn_get_option(enum jsn_option option);
+
+/**
+ * Sets the number of threads JSN_OPTION_PARALLEL parses on, zero (the default)
+ * uses one per online CPU. One thread parses on the calling thread only.
+ */
+void jsn_set_parallel_threads(unsigned int thread_count);
+
+/* ALLOCATOR
+ * ------------------------------------------------------------------------- */
+
+/**
+ * The functions used for all of the library's own memory. They're called with
+ * the allocator's user data, and from worker threads as well when parsing on
+ * multiple threads. Buffers that are handed to the caller (jsn_to_buffer,
+ * jsn_to_binary and the array of jsn_ndjson_from_buffer) always use malloc,
+ * so that they can be released with free.
+ */
+struct jsn_allocator {
+    void *(*malloc)(void *user_data, size_t size);
+    void *(*realloc)(void *user_data, void *memory, size_t size);
+    void (*free)(void *user_data, void *memory);
+    void *user_data;
+};
+
+/**
+ * Counts of the library's calls to its allocator.
+ */
+struct jsn_allocation_stats {
+    size_t allocations;
+    size_t reallocations;
+    size_t frees;
+    // The total number of requested bytes, including reallocations.
+    size_t bytes;
+};
+
+/**
+ * Sets the allocator, or restores malloc, realloc and free when NULL. Only
+ * change the allocator while no documents exist, as memory is released by
+ * whichever allocator is set at that time.
+ */
+void jsn_set_allocator(const struct jsn_allocator *allocator);
+
+/**
+ * Starts adding the library's allocations to the given statistics, or stops
+ * counting when NULL. Allocations made on the library's worker threads are
+ * counted as well. Only start or stop counting while the library isn't being
+ * used by other threads.
+ */
+void jsn_count_allocations(struct jsn_allocation_stats *stats);
+
+/* STATISTICS
+ * ------------------------------------------------------------------------- */
+
+/**
+ * Counts of what the parser did, they're only collected when the library is
+ * compiled with JSN_STATS defined. Counters are kept per thread and add up
+ * until they're reset, so reset them before a parse to measure just that
+ * parse.
+ */
+struct jsn_stats {
+    // Tokens read, by kind.
+    size_t object_tokens;
+    size_t array_tokens;
+    // Closing braces and brackets.
+    size_t close_tokens;
+    // Commas and colons.
+    size_t separator_tokens;
+    size_t string_tokens;
+    size_t integer_tokens;
+    size_t double_tokens;
+    size_t boolean_tokens;
+    size_t null_tokens;
+
+    // Source bytes examined by the tokenizer, including whitespace.
+    size_t bytes_scanned;
+
+    // String values copied out of the source.
+    size_t strings_copied;
+
+    // Keys copied out of the source. Short keys are copied into each node,
+    // longer keys only once per document and shared.
+    size_t keys_copied;
+
+    // The deepest nesting of objects and arrays, the root being one.
+    unsigned int max_depth;
+
+    // Times a children array, or the parser's stack of children, had to
+    // grow.
+    size_t children_reallocations;
+};
+
+/**
+ * Copies the calling thread's counters into the given stats. Returns false,
+ * with all counts zero, when the library was compiled without JSN_STATS.
+ */
+bool jsn_get_stats(struct jsn_stats *stats);
+
+/**
+ * Sets all of the calling thread's counters back to zero.
+ */
+void jsn_reset_stats();
+
 /* PARSING, SAVING AND OUTPUTTING FUNCTIONS
  * ------------------------------------------------------------------------- */
 
@@ -31,16 +189,393 @@ void jsn_print(jsn_handle handle);
 /**
  * Opens the given JSON file and parses it into a tree structure. It will
  * call exit if there's any issues opening or parsing the file. Else it will
- * return a handle to the root node.
+ * return a handle to the root node. Files are memory mapped where possible.
  */
 jsn_handle jsn_from_file(const char *file_path);
 
+/**
+ * Parses the JSON in the given buffer, of the given length in bytes, into a
+ * tree structure. The buffer doesn't need to be null terminated. It will call
+ * exit if there's any issues parsing the JSON.
+ */
+jsn_handle jsn_from_buffer(const char *buffer, size_t length);
+
+/**
+ * Parses the JSON in the given buffer in place, without copying any keys or
+ * strings. The buffer get's modified while parsing and it must outlive the
+ * returned document. It will call exit if there's any issues parsing the JSON.
+ */
+jsn_handle jsn_from_buffer_insitu(char *buffer, size_t length);
+
 /**
  * Will write the JSON of the given handle (node) to a file specified by the
  * given path.
  */
 void jsn_to_file(jsn_handle handle, const char *file_path);
 
+/**
+ * Returns the JSON of the given handle (node) as a newly allocated, null
+ * terminated string, that must be freed by the caller. The string's length is
+ * stored in the given length argument, unless it's NULL.
+ */
+char *jsn_to_buffer(jsn_handle handle, size_t *length);
+
+/**
+ * Returns the compact binary encoding of the given handle (node) as a newly
+ * allocated buffer, that must be freed by the caller. The buffer's length is
+ * stored in the given length argument.
+ */
+char *jsn_to_binary(jsn_handle handle, size_t *length);
+
+/**
+ * Decodes a buffer created by jsn_to_binary, of the given length in bytes,
+ * into a tree structure. It will call exit if the buffer is not valid.
+ */
+jsn_handle jsn_from_binary(const char *buffer, size_t length);
+
+/* INCREMENTAL PARSING FUNCTIONS
+ * ------------------------------------------------------------------------- */
+
+/**
+ * A parser that's fed the JSON in chunks, as they arrive.
+ */
+struct jsn_parser;
+
+/**
+ * Creates a new incremental parser.
+ */
+struct jsn_parser *jsn_parser_new();
+
+/**
+ * Parses the next chunk of JSON. Strings, numbers and literals may be split
+ * across chunks, the chunk itself is not used anymore once this returns. It
+ * will call exit if there's any issues parsing the JSON.
+ */
+void jsn_parser_feed(struct jsn_parser *parser, const char *chunk,
+                     size_t length);
+
+/**
+ * Finishes parsing and frees the parser. It will call exit if the JSON is
+ * incomplete. Else it will return a handle to the root node.
+ */
+jsn_handle jsn_parser_finish(struct jsn_parser *parser);
+
+/**
+ * Frees the parser and everything it has parsed so far, without finishing.
+ */
+void jsn_parser_free(struct jsn_parser *parser);
+
+/* EVENT PARSING FUNCTIONS
+ * ------------------------------------------------------------------------- */
+
+/**
+ * Callbacks for the event parsing functions, any of them can be NULL. Strings
+ * and keys are not null terminated, they point into the parsed JSON and are
+ * only valid during the callback.
+ */
+struct jsn_handler {
+    void (*on_object_start)(void *user_data);
+    void (*on_object_end)(void *user_data);
+    void (*on_array_start)(void *user_data);
+    void (*on_array_end)(void *user_data);
+    void (*on_key)(void *user_data, const char *key, size_t length);
+    void (*on_string)(void *user_data, const char *value, size_t length);
+    void (*on_integer)(void *user_data, int value);
+    void (*on_double)(void *user_data, double value);
+    void (*on_boolean)(void *user_data, bool value);
+    void (*on_null)(void *user_data);
+};
+
+/**
+ * Parses the JSON in the given buffer and calls the handler's callbacks for
+ * every value, without building a tree. It will call exit if there's any
+ * issues parsing the JSON.
+ */
+void jsn_events_from_buffer(const char *buffer, size_t length,
+                            const struct jsn_handler *handler,
+                            void *user_data);
+
+/**
+ * Opens the given JSON file and calls the handler's callbacks for every value,
+ * without building a tree. It will call exit if there's any issues opening or
+ * parsing the file.
+ */
+void jsn_events_from_file(const char *file_path,
+                          const struct jsn_handler *handler, void *user_data);
+
+/* NDJSON FUNCTIONS
+ * ------------------------------------------------------------------------- */
+
+/**
+ * Parses newline delimited JSON (JSON Lines), where every line holds a record,
+ * on the given number of threads. Zero threads uses all cores. Returns the
+ * records in input order, as a newly allocated array that must be freed by
+ * the caller, just like every record. The number of records is stored in the
+ * given count argument. Blank lines are skipped. It will call exit if there's
+ * any issues parsing the JSON.
+ */
+jsn_handle *jsn_ndjson_from_buffer(const char *buffer, size_t length,
+                                   unsigned int thread_count, size_t *count);
+
+/**
+ * Parses newline delimited JSON just like jsn_ndjson_from_buffer, but hands
+ * every record to the callback, which then owns it. The callback is called
+ * from the worker threads, at the same time and in no particular order.
+ */
+void jsn_ndjson_for_each(const char *buffer, size_t length,
+                         unsigned int thread_count,
+                         void (*callback)(void *user_data, jsn_handle record),
+                         void *user_data);
+
+/**
+ * Opens the given newline delimited JSON file and hands every record to the
+ * callback, just like jsn_ndjson_for_each.
+ */
+void jsn_ndjson_for_each_in_file(const char *file_path,
+                                 unsigned int thread_count,
+                                 void (*callback)(void *user_data,
+                                                  jsn_handle record),
+                                 void *user_data);
+
+/* ON-DEMAND CURSOR FUNCTIONS
+ * ------------------------------------------------------------------------- */
+
+/**
+ * A cursor points at a value inside of a JSON buffer. Values are only read
+ * when asked for, everything else is skipped without being parsed. The
+ * buffer must outlive it's cursors. The fields are private.
+ */
+struct jsn_cursor {
+    const char *source;
+    size_t length;
+    size_t position;
+};
+
+/**
+ * Returns a cursor to the root value of the JSON in the given buffer, of the
+ * given length in bytes. The buffer doesn't need to be null terminated.
+ */
+struct jsn_cursor jsn_cursor_from_buffer(const char *buffer, size_t length);
+
+/**
+ * Returns a cursor to the value matching the provided key hierarchy, just
+ * like jsn_get.
+ */
+struct jsn_cursor jsn_cursor_get(struct jsn_cursor cursor,
+                                 unsigned int arg_count, ...);
+
+/**
+ * Returns a cursor to an array's item, at the given index.
+ */
+struct jsn_cursor jsn_cursor_get_array_item(struct jsn_cursor cursor,
+                                            unsigned int index);
+
+/**
+ * Returns the total number of items of the array the cursor points at.
+ */
+unsigned int jsn_cursor_array_count(struct jsn_cursor cursor);
+
+/**
+ * Get a values integer value.
+ */
+int jsn_cursor_get_value_int(struct jsn_cursor cursor);
+
+/**
+ * Get a values boolean value.
+ */
+bool jsn_cursor_get_value_bool(struct jsn_cursor cursor);
+
+/**
+ * Get a values double value.
+ */
+double jsn_cursor_get_value_double(struct jsn_cursor cursor);
+
+/**
+ * Get a values string value, it points into the buffer and is not null
+ * terminated. It's length is stored in the given length argument.
+ */
+const char *jsn_cursor_get_value_string(struct jsn_cursor cursor,
+                                        size_t *length);
+
+/**
+ * Will return true if the cursor points at a null value.
+ */
+bool jsn_cursor_is_value_null(struct jsn_cursor cursor);
+
+/* FROZEN SNAPSHOT FUNCTIONS
+ * ------------------------------------------------------------------------- */
+
+/**
+ * A snapshot is a document written out in a layout that's read in place, it's
+ * memory mapped and shared between processes. Snapshots are read only.
+ */
+struct jsn_snapshot;
+
+/**
+ * Points at a value inside of a snapshot, the snapshot must outlive it. The
+ * fields are private.
+ */
+struct jsn_frozen {
+    const char *image;
+    size_t offset;
+};
+
+/**
+ * Will write a snapshot of the given handle (node) to a file specified by the
+ * given path. It will call exit if the file can't be written in full.
+ */
+void jsn_to_snapshot(jsn_handle handle, const char *file_path);
+
+/**
+ * Opens the given snapshot file without reading it. It will call exit if
+ * there's any issues opening the file or if it's not a complete snapshot.
+ */
+struct jsn_snapshot *jsn_snapshot_open(const char *file_path);
+
+/**
+ * Returns the snapshot's root value.
+ */
+struct jsn_frozen jsn_snapshot_root(struct jsn_snapshot *snapshot);
+
+/**
+ * Closes the snapshot, it's values can't be used anymore.
+ */
+void jsn_snapshot_close(struct jsn_snapshot *snapshot);
+
+/**
+ * Returns the value matching the provided key hierarchy, just like jsn_get.
+ */
+struct jsn_frozen jsn_frozen_get(struct jsn_frozen frozen,
+                                 unsigned int arg_count, ...);
+
+/**
+ * Returns an array's item, at the given index.
+ */
+struct jsn_frozen jsn_frozen_get_array_item(struct jsn_frozen frozen,
+                                            unsigned int index);
+
+/**
+ * Returns the total number of items of the given array.
+ */
+unsigned int jsn_frozen_array_count(struct jsn_frozen frozen);
+
+/**
+ * Get a values integer value.
+ */
+int jsn_frozen_get_value_int(struct jsn_frozen frozen);
+
+/**
+ * Get a values boolean value.
+ */
+bool jsn_frozen_get_value_bool(struct jsn_frozen frozen);
+
+/**
+ * Get a values double value.
+ */
+double jsn_frozen_get_value_double(struct jsn_frozen frozen);
+
+/**
+ * Get a values string value, it points into the snapshot.
+ */
+const char *jsn_frozen_get_value_string(struct jsn_frozen frozen);
+
+/**
+ * Will return true if the value is null.
+ */
+bool jsn_frozen_is_value_null(struct jsn_frozen frozen);
+
+/* TAPE FUNCTIONS
+ * ------------------------------------------------------------------------- */
+
+/**
+ * A tape is a read only document stored as one contiguous array of fixed size
+ * entries, with it's strings in a separate buffer. It takes less memory than
+ * a tree and is faster to parse and search, but can't be changed. Convert it
+ * to a tree with jsn_tape_to_tree when it needs to be.
+ */
+struct jsn_tape;
+
+/**
+ * Points at a value on a tape, the tape must outlive it. The fields are
+ * private.
+ */
+struct jsn_tape_value {
+    const struct jsn_tape *tape;
+    size_t index;
+};
+
+/**
+ * Parses the JSON in the given buffer, of the given length in bytes, onto a
+ * new tape. The buffer doesn't need to be null terminated. It will call exit
+ * if there's any issues parsing the JSON.
+ */
+struct jsn_tape *jsn_tape_from_buffer(const char *buffer, size_t length);
+
+/**
+ * Opens the given JSON file and parses it onto a new tape. It will call exit
+ * if there's any issues opening or parsing the file.
+ */
+struct jsn_tape *jsn_tape_from_file(const char *file_path);
+
+/**
+ * Returns the tape's root value.
+ */
+struct jsn_tape_value jsn_tape_root(const struct jsn_tape *tape);
+
+/**
+ * Frees the tape, it's values can't be used anymore.
+ */
+void jsn_tape_free(struct jsn_tape *tape);
+
+/**
+ * Returns the value matching the provided key hierarchy, just like jsn_get.
+ */
+struct jsn_tape_value jsn_tape_get(struct jsn_tape_value value,
+                                   unsigned int arg_count, ...);
+
+/**
+ * Returns an array's item, at the given index. It's found by jumping over the
+ * items before it, one jump per item.
+ */
+struct jsn_tape_value jsn_tape_get_array_item(struct jsn_tape_value value,
+                                              unsigned int index);
+
+/**
+ * Returns the total number of items of the given array.
+ */
+unsigned int jsn_tape_array_count(struct jsn_tape_value value);
+
+/**
+ * Get a values integer value.
+ */
+int jsn_tape_get_value_int(struct jsn_tape_value value);
+
+/**
+ * Get a values boolean value.
+ */
+bool jsn_tape_get_value_bool(struct jsn_tape_value value);
+
+/**
+ * Get a values double value.
+ */
+double jsn_tape_get_value_double(struct jsn_tape_value value);
+
+/**
+ * Get a values string value, it points into the tape.
+ */
+const char *jsn_tape_get_value_string(struct jsn_tape_value value);
+
+/**
+ * Will return true if the value is null.
+ */
+bool jsn_tape_is_value_null(struct jsn_tape_value value);
+
+/**
+ * Copies the given value into a new tree, that can be changed and must be
+ * freed with jsn_free.
+ */
+jsn_handle jsn_tape_to_tree(struct jsn_tape_value value);
+
 /* TREE CREATION AND DELETION FUNCTIONS
  * ------------------------------------------------------------------------- */
 
@@ -99,7 +634,8 @@ unsigned int jsn_array_count(jsn_handle handle);
 
 /**
  * Will recursively free the handle (node). Please note, that you should only
- * every free the root node.
+ * every free the root node. Nodes that belong to an arena are released
+ * together with their document's root node.
  */
 void jsn_free(jsn_handle handle);
 
@@ -178,4 +714,42 @@ void jsn_set_as_boolean(jsn_handle handle, bool value);
  */
 void jsn_set_as_string(jsn_handle handle, const char *value);
 
+/* COMPILED PATH FUNCTIONS
+ * ------------------------------------------------------------------------- */
+
+/**
+ * A compiled path, for looking up the same value in many documents. The
+ * fields are private.
+ */
+struct jsn_path;
+
+/**
+ * Compiles the given path expression, object keys are separated by dots and
+ * array indexes are placed in brackets, for example "statuses[3].user.name".
+ * Returns NULL if the expression is invalid.
+ */
+struct jsn_path *jsn_path_compile(const char *expression);
+
+/**
+ * Returns the node at the given path, starting from the given handle. Unlike
+ * jsn_get, it returns NULL when a key or index is missing.
+ */
+jsn_handle jsn_path_eval(const struct jsn_path *path, jsn_handle handle);
+
+/**
+ * Frees the compiled path.
+ */
+void jsn_path_free(struct jsn_path *path);
+
+/**
+ * Parses only the values at the given paths from the JSON in the given
+ * buffer, in a single pass that skips everything else. The value of each path
+ * is stored at the same position in the values array, or NULL when it's
+ * missing. The values belong to the returned document, which only holds the
+ * selected values (it's arrays only keep the selected items). Free it with
+ * jsn_free once done, NULL is returned when none of the paths were found.
+ */
+jsn_handle jsn_project(struct jsn_path *const *paths, unsigned int count,
+                       const char *buffer, size_t length, jsn_handle *values);
+
 #endif
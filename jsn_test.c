@@ -8,8 +8,10 @@
 
 #include "./jsn.h"
 #include <check.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* CONSTANTS:
  * --------------------------------------------------------------------------*/
@@ -28,6 +30,39 @@
             "./data/data_bad_3.json", "./data/data_bad_4.json"                 \
     }
 
+/* UTILITIES:
+ * --------------------------------------------------------------------------*/
+
+/**
+ * Reads the whole file into a newly allocated, null terminated string.
+ */
+char *jsn_testing_read_file(const char *file_path) {
+    FILE *file_ptr = fopen(file_path, "r");
+    ck_assert_ptr_nonnull(file_ptr);
+
+    fseek(file_ptr, 0, SEEK_END);
+    long file_size = ftell(file_ptr);
+    fseek(file_ptr, 0, SEEK_SET);
+
+    char *buffer = malloc(file_size + 1);
+    ck_assert_int_eq(fread(buffer, 1, file_size, file_ptr), file_size);
+    buffer[file_size] = '\0';
+    fclose(file_ptr);
+
+    return buffer;
+}
+
+/**
+ * Parses the file and returns the JSON it writes back out.
+ */
+char *jsn_testing_reserialize(const char *file_path) {
+    jsn_handle root = jsn_from_file(file_path);
+    jsn_to_file(root, "./data/data_written.json");
+    jsn_free(root);
+
+    return jsn_testing_read_file("./data/data_written.json");
+}
+
 /* PARSING, PRINTING AND SAVING
  * --------------------------------------------------------------------------*/
 
@@ -54,6 +89,79 @@ START_TEST(jsn_to_file_test) {
 }
 END_TEST
 
+/**
+ * Checks that the JSON written to a buffer matches the JSON written to a file.
+ */
+START_TEST(jsn_to_buffer_test) {
+    for (unsigned int i = 0; i < JSN_TESTING_DATA_FILE_COUNT; i++) {
+        const char *path = JSN_TESTING_DATA_FILES_PATHS[i];
+        char *expected = jsn_testing_reserialize(path);
+
+        jsn_handle root_node = jsn_from_file(path);
+        size_t length;
+        char *buffer = jsn_to_buffer(root_node, &length);
+        jsn_free(root_node);
+
+        ck_assert_int_eq(length, strlen(expected));
+        ck_assert_str_eq(buffer, expected);
+        free(buffer);
+        free(expected);
+    }
+}
+END_TEST
+
+/**
+ * Checks that doubles and integers are written in a form that parses back to
+ * the exact same values.
+ */
+START_TEST(jsn_number_round_trip_test) {
+    const double doubles[] = {0.1,
+                              -0.0,
+                              1e-9,
+                              -65.613616999999977,
+                              5e-324,
+                              1e21,
+                              123.0,
+                              1.7976931348623157e308,
+                              0.001234,
+                              2.5e-5,
+                              1e100,
+                              2.2250738585072014e-308};
+    const int integers[] = {0, -1, 9, 10, -99, 2147483647, -2147483647 - 1};
+
+    jsn_handle array = jsn_create_array();
+    for (unsigned int i = 0; i < sizeof(doubles) / sizeof(double); i++) {
+        jsn_array_push(array, jsn_create_double(doubles[i]));
+    }
+    for (unsigned int i = 0; i < sizeof(integers) / sizeof(int); i++) {
+        jsn_array_push(array, jsn_create_integer(integers[i]));
+    }
+
+    size_t length;
+    char *buffer = jsn_to_buffer(array, &length);
+    jsn_free(array);
+
+    ck_assert_str_eq(buffer, "[0.1,-0.0,1e-9,-65.61361699999998,5e-324,1e21,"
+                             "123.0,1.7976931348623157e308,0.001234,0.000025,"
+                             "1e100,2.2250738585072014e-308,0,-1,9,10,-99,"
+                             "2147483647,-2147483648]");
+
+    jsn_handle parsed = jsn_from_buffer(buffer, length);
+    unsigned int count = sizeof(doubles) / sizeof(double);
+    for (unsigned int i = 0; i < count; i++) {
+        double value = jsn_get_value_double(jsn_get_array_item(parsed, i));
+        ck_assert_int_eq(memcmp(&value, &doubles[i], sizeof(double)), 0);
+    }
+    for (unsigned int i = 0; i < sizeof(integers) / sizeof(int); i++) {
+        jsn_handle item = jsn_get_array_item(parsed, count + i);
+        ck_assert_int_eq(jsn_get_value_int(item), integers[i]);
+    }
+
+    jsn_free(parsed);
+    free(buffer);
+}
+END_TEST
+
 /**
  * Checks that bad file paths will cause exit failure.
  */
@@ -72,6 +180,769 @@ START_TEST(jsn_from_file_bad_file_test) {
 }
 END_TEST
 
+/**
+ * Checks that strings with escapes at every offset around the SIMD block sizes
+ * are scanned the same by the SIMD and scalar string scanners.
+ */
+START_TEST(jsn_string_scanning_test) {
+    char value[128];
+    char key[16];
+
+    // Build strings of growing lengths, with an escaped quote and backslash.
+    jsn_handle root = jsn_create_object();
+    for (unsigned int i = 0; i < 100; i++) {
+        memset(value, 'a', i);
+        strcpy(&value[i], "\\\"b\\\\c");
+        snprintf(key, sizeof(key), "key-%u", i);
+        jsn_object_set(root, key, jsn_create_string(value));
+    }
+    jsn_to_file(root, "./data/data_written.json");
+
+    for (unsigned int scalar = 0; scalar < 2; scalar++) {
+        jsn_set_option(JSN_OPTION_SCALAR, scalar);
+        jsn_handle parsed = jsn_from_file("./data/data_written.json");
+
+        for (unsigned int i = 0; i < 100; i++) {
+            snprintf(key, sizeof(key), "key-%u", i);
+            ck_assert_str_eq(jsn_get_value_string(jsn_get(parsed, 1, key)),
+                             jsn_get_value_string(jsn_get(root, 1, key)));
+        }
+
+        jsn_free(parsed);
+    }
+
+    jsn_set_option(JSN_OPTION_SCALAR, false);
+    jsn_free(root);
+}
+END_TEST
+
+/**
+ * Checks that the two stage parse mode builds the same trees as the regular
+ * parser, using both the SIMD and the scalar block classifiers.
+ */
+START_TEST(jsn_structural_index_test) {
+    const char *paths[] = {"./data/data_1.json", "./data/data_2.json",
+                           "./data/data_3.json", "./data/data_4.json",
+                           "./data/learn.json",
+                           "./benchmark/data/twitter.json"};
+
+    for (unsigned int i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        char *expected = jsn_testing_reserialize(paths[i]);
+
+        for (unsigned int scalar = 0; scalar < 2; scalar++) {
+            jsn_set_option(JSN_OPTION_STRUCTURAL_INDEX, true);
+            jsn_set_option(JSN_OPTION_SCALAR, scalar);
+            char *actual = jsn_testing_reserialize(paths[i]);
+            jsn_set_option(JSN_OPTION_STRUCTURAL_INDEX, false);
+            jsn_set_option(JSN_OPTION_SCALAR, false);
+
+            ck_assert_str_eq(actual, expected);
+            free(actual);
+        }
+
+        free(expected);
+    }
+}
+END_TEST
+
+/**
+ * Checks that escapes and quotes that straddle the 64 byte blocks of the
+ * structural index are handled.
+ */
+START_TEST(jsn_structural_index_escapes_test) {
+    char value[160];
+    char key[16];
+
+    // Runs of backslashes end at every offset of a block.
+    jsn_handle root = jsn_create_array();
+    for (unsigned int i = 0; i < 130; i++) {
+        memset(value, 'a', i);
+        strcpy(&value[i], "\\\\\\\"{[,:]}\\\\");
+        snprintf(key, sizeof(key), "%u", i);
+
+        jsn_handle object = jsn_array_push(root, jsn_create_object());
+        jsn_object_set(object, key, jsn_create_string(value));
+        jsn_object_set(object, "n", jsn_create_integer(i));
+    }
+    jsn_to_file(root, "./data/data_written.json");
+    jsn_free(root);
+
+    char *expected = jsn_testing_reserialize("./data/data_written.json");
+
+    for (unsigned int scalar = 0; scalar < 2; scalar++) {
+        jsn_set_option(JSN_OPTION_STRUCTURAL_INDEX, true);
+        jsn_set_option(JSN_OPTION_SCALAR, scalar);
+        char *actual = jsn_testing_reserialize("./data/data_written.json");
+        jsn_set_option(JSN_OPTION_STRUCTURAL_INDEX, false);
+        jsn_set_option(JSN_OPTION_SCALAR, false);
+
+        ck_assert_str_eq(actual, expected);
+        free(actual);
+    }
+
+    free(expected);
+}
+END_TEST
+
+/**
+ * Checks that the two stage parse mode also fails on bad files.
+ */
+START_TEST(jsn_structural_index_bad_file_test) {
+    jsn_set_option(JSN_OPTION_STRUCTURAL_INDEX, true);
+    for (unsigned int i = 0; i < JSN_TESTING_BAD_DATA_FILE_COUNT; i++) {
+        jsn_from_file(JSN_TESTING_BAD_DATA_FILES_PATHS[i]);
+    }
+}
+END_TEST
+
+/**
+ * Checks that numbers, including exponents, are parsed into the same values
+ * strtod would return.
+ */
+START_TEST(jsn_number_parsing_test) {
+    const char *numbers[] = {"1e5",
+                             "-2.5E-3",
+                             "1E+2",
+                             "0.1",
+                             "-65.613616999999977",
+                             "1.7976931348623157e308",
+                             "2.2250738585072014e-308",
+                             "4.9e-324",
+                             "9007199254740993.0",
+                             "123456789012345678901234567890.5",
+                             "0.000000000000000000000000000001"};
+    unsigned int count = sizeof(numbers) / sizeof(numbers[0]);
+
+    // Write all numbers into an array.
+    FILE *file_ptr = fopen("./data/data_written.json", "w");
+    fprintf(file_ptr, "[-42");
+    for (unsigned int i = 0; i < count; i++) {
+        fprintf(file_ptr, ", %s", numbers[i]);
+    }
+    fprintf(file_ptr, "]");
+    fclose(file_ptr);
+
+    jsn_handle root = jsn_from_file("./data/data_written.json");
+    ck_assert_int_eq(jsn_array_count(root), count + 1);
+    ck_assert_int_eq(jsn_get_value_int(jsn_get_array_item(root, 0)), -42);
+
+    for (unsigned int i = 0; i < count; i++) {
+        jsn_handle item = jsn_get_array_item(root, i + 1);
+        ck_assert_double_eq(jsn_get_value_double(item),
+                            strtod(numbers[i], NULL));
+    }
+
+    jsn_free(root);
+}
+END_TEST
+
+/**
+ * Parsed documents share repeated keys between their objects, freeing and
+ * replacing some of these objects must leave the others intact.
+ */
+START_TEST(jsn_key_interning_test) {
+    jsn_handle root = jsn_create_array();
+    for (int i = 0; i < 100; i++) {
+        jsn_handle item = jsn_array_push(root, jsn_create_object());
+        jsn_object_set(item, "id", jsn_create_integer(i));
+        jsn_object_set(item, "name", jsn_create_string("item"));
+    }
+    jsn_to_file(root, "./data/data_written.json");
+    jsn_free(root);
+
+    root = jsn_from_file("./data/data_written.json");
+    for (int i = 0; i < 100; i += 2) {
+        jsn_handle item = jsn_get_array_item(root, i);
+        if (i % 4 == 0) {
+            jsn_set_as_object(item);
+        }
+        jsn_object_set(item, "name", jsn_create_string("replaced"));
+    }
+
+    for (int i = 0; i < 100; i++) {
+        jsn_handle item = jsn_get_array_item(root, i);
+        const char *name = i % 2 == 0 ? "replaced" : "item";
+        ck_assert_str_eq(jsn_get_value_string(jsn_get(item, 1, "name")), name);
+        if (i % 4 != 0) {
+            ck_assert_int_eq(jsn_get_value_int(jsn_get(item, 1, "id")), i);
+        }
+    }
+
+    jsn_free(root);
+}
+END_TEST
+
+START_TEST(jsn_from_buffer_test) {
+    for (int i = 0; i < JSN_TESTING_DATA_FILE_COUNT; i++) {
+        const char *path = JSN_TESTING_DATA_FILES_PATHS[i];
+        char *expected = jsn_testing_reserialize(path);
+
+        // Copy the JSON into a buffer without a null terminator.
+        char *contents = jsn_testing_read_file(path);
+        size_t length = strlen(contents);
+        char *buffer = malloc(length);
+        memcpy(buffer, contents, length);
+        free(contents);
+
+        jsn_handle root = jsn_from_buffer(buffer, length);
+        jsn_to_file(root, "./data/data_written.json");
+        jsn_free(root);
+        free(buffer);
+
+        char *written = jsn_testing_read_file("./data/data_written.json");
+        ck_assert_str_eq(written, expected);
+        free(written);
+        free(expected);
+    }
+}
+END_TEST
+
+START_TEST(jsn_from_buffer_truncated_test) {
+    // The parser must not read past the end of the buffer.
+    char *buffer = malloc(4);
+    memcpy(buffer, "[tru", 4);
+    jsn_from_buffer(buffer, 4);
+}
+END_TEST
+
+START_TEST(jsn_parser_feed_test) {
+    const size_t chunk_sizes[] = {1, 3, 7, 64, 4096};
+
+    for (int i = 0; i < JSN_TESTING_DATA_FILE_COUNT; i++) {
+        const char *path = JSN_TESTING_DATA_FILES_PATHS[i];
+        char *expected = jsn_testing_reserialize(path);
+        char *contents = jsn_testing_read_file(path);
+        size_t length = strlen(contents);
+
+        // Tokens get split at every possible place with the smaller chunks.
+        for (int j = 0; j < 5; j++) {
+            struct jsn_parser *parser = jsn_parser_new();
+            for (size_t offset = 0; offset < length; offset += chunk_sizes[j]) {
+                size_t remaining = length - offset;
+                jsn_parser_feed(parser, &contents[offset],
+                                remaining < chunk_sizes[j] ? remaining
+                                                           : chunk_sizes[j]);
+            }
+
+            jsn_handle root = jsn_parser_finish(parser);
+            jsn_to_file(root, "./data/data_written.json");
+            jsn_free(root);
+
+            char *written = jsn_testing_read_file("./data/data_written.json");
+            ck_assert_str_eq(written, expected);
+            free(written);
+        }
+
+        free(contents);
+        free(expected);
+    }
+
+    // A number at the end of the input is only complete when finishing.
+    struct jsn_parser *parser = jsn_parser_new();
+    jsn_parser_feed(parser, "-12", 3);
+    jsn_parser_feed(parser, "5e-1", 4);
+    jsn_handle root = jsn_parser_finish(parser);
+    ck_assert_double_eq(jsn_get_value_double(root), -12.5);
+    jsn_free(root);
+
+    // Unfinished parsers can be freed along with their nodes.
+    parser = jsn_parser_new();
+    jsn_parser_feed(parser, "{\"a\": [1, {\"b\": \"c\"}, [tr", 25);
+    jsn_parser_free(parser);
+}
+END_TEST
+
+START_TEST(jsn_parser_incomplete_test) {
+    struct jsn_parser *parser = jsn_parser_new();
+    jsn_parser_feed(parser, "{\"a\": [1, 2", 12);
+    jsn_parser_finish(parser);
+}
+END_TEST
+
+/**
+ * Event callbacks, that log every event into a string.
+ */
+void jsn_testing_log(void *log, const char *event) { strcat(log, event); }
+void jsn_testing_object_start(void *log) { jsn_testing_log(log, "{"); }
+void jsn_testing_object_end(void *log) { jsn_testing_log(log, "}"); }
+void jsn_testing_array_start(void *log) { jsn_testing_log(log, "["); }
+void jsn_testing_array_end(void *log) { jsn_testing_log(log, "]"); }
+void jsn_testing_null(void *log) { jsn_testing_log(log, "n"); }
+
+void jsn_testing_key(void *log, const char *key, size_t length) {
+    strncat(log, key, length);
+    jsn_testing_log(log, ":");
+}
+
+void jsn_testing_string(void *log, const char *value, size_t length) {
+    jsn_testing_log(log, "s");
+    strncat(log, value, length);
+}
+
+void jsn_testing_integer(void *log, int value) {
+    sprintf(&((char *)log)[strlen(log)], "i%d", value);
+}
+
+void jsn_testing_double(void *log, double value) {
+    sprintf(&((char *)log)[strlen(log)], "d%g", value);
+}
+
+void jsn_testing_boolean(void *log, bool value) {
+    jsn_testing_log(log, value ? "t" : "f");
+}
+
+START_TEST(jsn_events_test) {
+    const struct jsn_handler handler = {
+        jsn_testing_object_start, jsn_testing_object_end,
+        jsn_testing_array_start,  jsn_testing_array_end,
+        jsn_testing_key,          jsn_testing_string,
+        jsn_testing_integer,      jsn_testing_double,
+        jsn_testing_boolean,      jsn_testing_null};
+    const char *json = "{\"a\": [1, -2.5, \"x\", true, false, null, {}],"
+                       " \"b\": {\"c\": []}, \"d\": \"\\\"\"}";
+    char log[256] = "";
+
+    jsn_events_from_buffer(json, strlen(json), &handler, log);
+    ck_assert_str_eq(log, "{a:[i1d-2.5sxtfn{}]b:{c:[]}d:s\\\"}");
+
+    // Callbacks can be left out, the tree isn't needed to walk a file.
+    const struct jsn_handler objects = {jsn_testing_object_start};
+    log[0] = '\0';
+    jsn_events_from_file(JSN_TESTING_DATA_FILES_PATHS[1], &objects, log);
+    ck_assert_str_eq(log, "{{");
+}
+END_TEST
+
+START_TEST(jsn_cursor_test) {
+    const char *json = "{\"skip\": {\"a\": [1, \"]}\\\"\", {}]}, \"items\": "
+                       "[10, -2.5, \"text\", true, null, [[]]], "
+                       "\"nested\": {\"value\": 42}}";
+    struct jsn_cursor root = jsn_cursor_from_buffer(json, strlen(json));
+    struct jsn_cursor value = jsn_cursor_get(root, 2, "nested", "value");
+    ck_assert_int_eq(jsn_cursor_get_value_int(value), 42);
+
+    struct jsn_cursor items = jsn_cursor_get(root, 1, "items");
+    ck_assert_int_eq(jsn_cursor_array_count(items), 6);
+
+    value = jsn_cursor_get_array_item(items, 0);
+    ck_assert_int_eq(jsn_cursor_get_value_int(value), 10);
+    value = jsn_cursor_get_array_item(items, 1);
+    ck_assert_double_eq(jsn_cursor_get_value_double(value), -2.5);
+    value = jsn_cursor_get_array_item(items, 3);
+    ck_assert(jsn_cursor_get_value_bool(value));
+    value = jsn_cursor_get_array_item(items, 4);
+    ck_assert(jsn_cursor_is_value_null(value));
+    value = jsn_cursor_get_array_item(items, 5);
+    ck_assert_int_eq(jsn_cursor_array_count(value), 1);
+
+    size_t length;
+    value = jsn_cursor_get_array_item(items, 2);
+    const char *text = jsn_cursor_get_value_string(value, &length);
+    ck_assert_int_eq(length, 4);
+    ck_assert(strncmp(text, "text", length) == 0);
+
+    // Cursors read the same values as the tree.
+    char *contents = jsn_testing_read_file(JSN_TESTING_DATA_FILES_PATHS[1]);
+    jsn_handle tree = jsn_from_file(JSN_TESTING_DATA_FILES_PATHS[1]);
+    root = jsn_cursor_from_buffer(contents, strlen(contents));
+
+    value = jsn_cursor_get(root, 1, "time_last_updated");
+    ck_assert_int_eq(jsn_cursor_get_value_int(value),
+                     jsn_get_value_int(jsn_get(tree, 1, "time_last_updated")));
+    value = jsn_cursor_get(root, 2, "rates", "ZWL");
+    ck_assert_double_eq(jsn_cursor_get_value_double(value),
+                        jsn_get_value_double(jsn_get(tree, 2, "rates", "ZWL")));
+
+    jsn_free(tree);
+    free(contents);
+}
+END_TEST
+
+START_TEST(jsn_cursor_unknown_key_test) {
+    const char *json = "{\"a\": {\"b\": 1}, \"c\": 2}";
+    struct jsn_cursor root = jsn_cursor_from_buffer(json, strlen(json));
+    jsn_cursor_get(root, 2, "a", "c");
+}
+END_TEST
+
+/**
+ * Checks that documents decoded from their binary encoding write out the same
+ * JSON as the original documents, with and without an arena.
+ */
+START_TEST(jsn_binary_test) {
+    for (int arena = 0; arena < 2; arena++) {
+        jsn_set_option(JSN_OPTION_ARENA, arena);
+
+        for (int i = 0; i < JSN_TESTING_DATA_FILE_COUNT; i++) {
+            const char *path = JSN_TESTING_DATA_FILES_PATHS[i];
+            jsn_handle original = jsn_from_file(path);
+            char *expected = jsn_to_buffer(original, NULL);
+
+            size_t length;
+            char *binary = jsn_to_binary(original, &length);
+            jsn_free(original);
+
+            jsn_handle decoded = jsn_from_binary(binary, length);
+            char *written = jsn_to_buffer(decoded, NULL);
+            jsn_free(decoded);
+
+            ck_assert_str_eq(written, expected);
+            free(binary);
+            free(written);
+            free(expected);
+        }
+    }
+
+    jsn_set_option(JSN_OPTION_ARENA, false);
+}
+END_TEST
+
+START_TEST(jsn_binary_truncated_test) {
+    jsn_handle array = jsn_create_array();
+    jsn_array_push(array, jsn_create_string("value"));
+
+    size_t length;
+    char *binary = jsn_to_binary(array, &length);
+    jsn_from_binary(binary, length - 1);
+}
+END_TEST
+
+START_TEST(jsn_snapshot_test) {
+    const char *json = "{\"items\": [10, -2.5, \"text\", true, null, [[]]], "
+                       "\"nested\": {\"value\": 42}, \"copy\": \"text\"}";
+    jsn_handle tree = jsn_from_buffer(json, strlen(json));
+    jsn_to_snapshot(tree, "./data/data_written.snapshot");
+    jsn_free(tree);
+
+    struct jsn_snapshot *snapshot =
+        jsn_snapshot_open("./data/data_written.snapshot");
+    struct jsn_frozen root = jsn_snapshot_root(snapshot);
+
+    struct jsn_frozen value = jsn_frozen_get(root, 2, "nested", "value");
+    ck_assert_int_eq(jsn_frozen_get_value_int(value), 42);
+
+    struct jsn_frozen items = jsn_frozen_get(root, 1, "items");
+    ck_assert_int_eq(jsn_frozen_array_count(items), 6);
+
+    value = jsn_frozen_get_array_item(items, 0);
+    ck_assert_int_eq(jsn_frozen_get_value_int(value), 10);
+    value = jsn_frozen_get_array_item(items, 1);
+    ck_assert_double_eq(jsn_frozen_get_value_double(value), -2.5);
+    value = jsn_frozen_get_array_item(items, 2);
+    ck_assert_str_eq(jsn_frozen_get_value_string(value), "text");
+    value = jsn_frozen_get_array_item(items, 3);
+    ck_assert(jsn_frozen_get_value_bool(value));
+    value = jsn_frozen_get_array_item(items, 4);
+    ck_assert(jsn_frozen_is_value_null(value));
+    value = jsn_frozen_get_array_item(items, 5);
+    ck_assert_int_eq(jsn_frozen_array_count(value), 1);
+
+    // Equal strings are only stored once.
+    value = jsn_frozen_get(root, 1, "copy");
+    ck_assert_ptr_eq(jsn_frozen_get_value_string(value),
+                     jsn_frozen_get_value_string(
+                         jsn_frozen_get_array_item(items, 2)));
+
+    jsn_snapshot_close(snapshot);
+
+    // Large objects are looked up through their key index.
+    tree = jsn_from_file(JSN_TESTING_DATA_FILES_PATHS[1]);
+    jsn_to_snapshot(tree, "./data/data_written.snapshot");
+    snapshot = jsn_snapshot_open("./data/data_written.snapshot");
+    root = jsn_snapshot_root(snapshot);
+
+    const char *currencies[] = {"AED", "AFN", "ZWL"};
+    for (unsigned int i = 0; i < 3; i++) {
+        value = jsn_frozen_get(root, 2, "rates", currencies[i]);
+        jsn_handle expected = jsn_get(tree, 2, "rates", currencies[i]);
+        ck_assert_double_eq(jsn_frozen_get_value_double(value),
+                            jsn_get_value_double(expected));
+    }
+
+    jsn_snapshot_close(snapshot);
+    jsn_free(tree);
+    remove("./data/data_written.snapshot");
+}
+END_TEST
+
+START_TEST(jsn_snapshot_unknown_key_test) {
+    jsn_handle tree = jsn_from_file(JSN_TESTING_DATA_FILES_PATHS[1]);
+    jsn_to_snapshot(tree, "./data/data_written.snapshot");
+
+    struct jsn_snapshot *snapshot =
+        jsn_snapshot_open("./data/data_written.snapshot");
+    remove("./data/data_written.snapshot");
+    jsn_frozen_get(jsn_snapshot_root(snapshot), 2, "rates", "XXX");
+}
+END_TEST
+
+void jsn_testing_remove_snapshot() { remove("./data/data_written.snapshot"); }
+
+START_TEST(jsn_snapshot_truncated_test) {
+    jsn_handle tree = jsn_from_file(JSN_TESTING_DATA_FILES_PATHS[1]);
+    jsn_to_snapshot(tree, "./data/data_written.snapshot");
+
+    // Keep only the first half, like a copy that was cut short.
+    FILE *file = fopen("./data/data_written.snapshot", "rb");
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file) / 2;
+    rewind(file);
+    char *contents = malloc(length);
+    ck_assert_int_eq(fread(contents, 1, length, file), length);
+    fclose(file);
+
+    file = fopen("./data/data_written.snapshot", "wb");
+    fwrite(contents, 1, length, file);
+    fclose(file);
+    free(contents);
+
+    // Opening it exits, which is when the snapshot gets removed.
+    atexit(jsn_testing_remove_snapshot);
+    jsn_snapshot_open("./data/data_written.snapshot");
+}
+END_TEST
+
+START_TEST(jsn_tape_test) {
+    const char *json = "{\"items\": [10, -2.5, \"text\", true, null, [[]]], "
+                       "\"nested\": {\"value\": 42}, \"empty\": {}}";
+    struct jsn_tape *tape = jsn_tape_from_buffer(json, strlen(json));
+    struct jsn_tape_value root = jsn_tape_root(tape);
+
+    struct jsn_tape_value value = jsn_tape_get(root, 2, "nested", "value");
+    ck_assert_int_eq(jsn_tape_get_value_int(value), 42);
+
+    struct jsn_tape_value items = jsn_tape_get(root, 1, "items");
+    ck_assert_int_eq(jsn_tape_array_count(items), 6);
+
+    value = jsn_tape_get_array_item(items, 0);
+    ck_assert_int_eq(jsn_tape_get_value_int(value), 10);
+    value = jsn_tape_get_array_item(items, 1);
+    ck_assert_double_eq(jsn_tape_get_value_double(value), -2.5);
+    value = jsn_tape_get_array_item(items, 2);
+    ck_assert_str_eq(jsn_tape_get_value_string(value), "text");
+    value = jsn_tape_get_array_item(items, 3);
+    ck_assert(jsn_tape_get_value_bool(value));
+    value = jsn_tape_get_array_item(items, 4);
+    ck_assert(jsn_tape_is_value_null(value));
+    value = jsn_tape_get_array_item(items, 5);
+    ck_assert_int_eq(jsn_tape_array_count(value), 1);
+    ck_assert_int_eq(jsn_tape_array_count(root), 0);
+
+    jsn_tape_free(tape);
+
+    // Converted tapes match the parsed trees, in both allocation modes.
+    for (int i = 0; i < JSN_TESTING_DATA_FILE_COUNT * 2; i++) {
+        jsn_set_option(JSN_OPTION_ARENA, i >= JSN_TESTING_DATA_FILE_COUNT);
+        const char *path =
+            JSN_TESTING_DATA_FILES_PATHS[i % JSN_TESTING_DATA_FILE_COUNT];
+
+        jsn_handle expected = jsn_from_file(path);
+        tape = jsn_tape_from_file(path);
+        jsn_handle tree = jsn_tape_to_tree(jsn_tape_root(tape));
+        jsn_tape_free(tape);
+
+        char *expected_json = jsn_to_buffer(expected, NULL);
+        char *tree_json = jsn_to_buffer(tree, NULL);
+        ck_assert_str_eq(tree_json, expected_json);
+
+        // The tree can be changed.
+        jsn_object_set(tree, "added", jsn_create_integer(1));
+
+        free(expected_json);
+        free(tree_json);
+        jsn_free(expected);
+        jsn_free(tree);
+    }
+    jsn_set_option(JSN_OPTION_ARENA, false);
+
+    // Lookups on a tape find the same values as on the tree.
+    jsn_handle tree = jsn_from_file(JSN_TESTING_DATA_FILES_PATHS[3]);
+    tape = jsn_tape_from_file(JSN_TESTING_DATA_FILES_PATHS[3]);
+    root = jsn_tape_root(tape);
+
+    struct jsn_tape_value children = jsn_tape_get(root, 2, "data", "children");
+    jsn_handle expected_children = jsn_get(tree, 2, "data", "children");
+    ck_assert_int_eq(jsn_tape_array_count(children),
+                     jsn_array_count(expected_children));
+
+    for (unsigned int i = 0; i < jsn_array_count(expected_children); i++) {
+        value = jsn_tape_get(jsn_tape_get_array_item(children, i), 2, "data",
+                             "title");
+        jsn_handle expected = jsn_get(
+            jsn_get_array_item(expected_children, i), 2, "data", "title");
+        ck_assert_str_eq(jsn_tape_get_value_string(value),
+                         jsn_get_value_string(expected));
+    }
+
+    jsn_tape_free(tape);
+    jsn_free(tree);
+}
+END_TEST
+
+START_TEST(jsn_tape_unknown_key_test) {
+    struct jsn_tape *tape = jsn_tape_from_file(JSN_TESTING_DATA_FILES_PATHS[1]);
+    jsn_tape_get(jsn_tape_root(tape), 2, "rates", "XXX");
+}
+END_TEST
+
+/**
+ * Returns newline delimited JSON with the given number of records, spread
+ * over multiple chunks. It's length is stored in the given length argument.
+ */
+char *jsn_testing_ndjson(unsigned int record_count, size_t *length) {
+    char *buffer = malloc(record_count * 80);
+    *length = 0;
+
+    for (unsigned int i = 0; i < record_count; i++) {
+        // Blank lines and carriage returns are skipped.
+        const char *ending = i % 7 == 0 ? "\r\n\n" : "\n";
+        *length += sprintf(&buffer[*length],
+                           "{\"id\": %u, \"name\": \"record %u\", "
+                           "\"values\": [1.5, -2]}%s",
+                           i, i, ending);
+    }
+
+    return buffer;
+}
+
+void jsn_testing_sum_ids(void *user_data, jsn_handle record) {
+    atomic_ulong *sum = user_data;
+    atomic_fetch_add(sum, jsn_get_value_int(jsn_get(record, 1, "id")));
+    jsn_free(record);
+}
+
+START_TEST(jsn_ndjson_test) {
+    const unsigned int record_count = 50000;
+    size_t length;
+    char *buffer = jsn_testing_ndjson(record_count, &length);
+
+    // Records come back in input order, no matter the number of threads.
+    const unsigned int thread_counts[] = {1, 4, 0};
+    for (unsigned int t = 0; t < 3; t++) {
+        size_t count;
+        jsn_handle *records =
+            jsn_ndjson_from_buffer(buffer, length, thread_counts[t], &count);
+        ck_assert_int_eq(count, record_count);
+
+        for (unsigned int i = 0; i < count; i++) {
+            ck_assert_int_eq(jsn_get_value_int(jsn_get(records[i], 1, "id")),
+                             i);
+            jsn_free(records[i]);
+        }
+        free(records);
+    }
+
+    atomic_ulong sum = 0;
+    jsn_ndjson_for_each(buffer, length, 4, jsn_testing_sum_ids, &sum);
+    unsigned long expected = (unsigned long)record_count * (record_count - 1);
+    ck_assert_uint_eq(sum, expected / 2);
+
+    free(buffer);
+}
+END_TEST
+
+/**
+ * Checks that large arrays parsed on multiple threads are identical to the
+ * ones parsed on a single thread, with and without an arena.
+ */
+START_TEST(jsn_parallel_test) {
+    size_t capacity = 6 << 20;
+    char *buffer = malloc(capacity + 256);
+    size_t length = sprintf(buffer, " [");
+
+    // Strings full of commas, brackets and escaped quotes.
+    for (unsigned int i = 0; length < capacity; i++) {
+        length += sprintf(&buffer[length],
+                          "%s{\"id\": %u, \"text\": \"a, [b] {c} \\\",\\\\\", "
+                          "\"values\": [%u.5, [\"x,y\"], {}], \"ok\": true}",
+                          i == 0 ? "" : ",\n", i, i);
+    }
+    length += sprintf(&buffer[length], "]");
+
+    // The thread counts are forced, so the parallel parse also runs on
+    // machines with a single CPU.
+    const unsigned int thread_counts[] = {2, 4, 7};
+
+    for (int arena = 0; arena < 2; arena++) {
+        jsn_set_option(JSN_OPTION_ARENA, arena);
+
+        jsn_handle serial = jsn_from_buffer(buffer, length);
+        char *expected = jsn_to_buffer(serial, NULL);
+        jsn_free(serial);
+
+        for (int i = 0; i < 3; i++) {
+            jsn_set_parallel_threads(thread_counts[i]);
+            jsn_set_option(JSN_OPTION_PARALLEL, true);
+            jsn_handle parallel = jsn_from_buffer(buffer, length);
+            jsn_set_option(JSN_OPTION_PARALLEL, false);
+
+            char *written = jsn_to_buffer(parallel, NULL);
+            ck_assert_str_eq(written, expected);
+
+            jsn_free(parallel);
+            free(written);
+        }
+
+        free(expected);
+    }
+
+    jsn_set_parallel_threads(0);
+    jsn_set_option(JSN_OPTION_ARENA, false);
+    free(buffer);
+}
+END_TEST
+
+START_TEST(jsn_from_buffer_insitu_test) {
+    for (int i = 0; i < JSN_TESTING_DATA_FILE_COUNT; i++) {
+        const char *path = JSN_TESTING_DATA_FILES_PATHS[i];
+        char *expected = jsn_testing_reserialize(path);
+
+        // Parse in place from a caller owned buffer.
+        char *buffer = jsn_testing_read_file(path);
+        jsn_handle root = jsn_from_buffer_insitu(buffer, strlen(buffer));
+        jsn_to_file(root, "./data/data_written.json");
+        jsn_free(root);
+        free(buffer);
+
+        char *written = jsn_testing_read_file("./data/data_written.json");
+        ck_assert_str_eq(written, expected);
+        free(written);
+
+        // Parse in place from a file, the document owns the file's contents.
+        jsn_set_option(JSN_OPTION_INSITU, true);
+        root = jsn_from_file(path);
+        jsn_to_file(root, "./data/data_written.json");
+        jsn_free(root);
+        jsn_set_option(JSN_OPTION_INSITU, false);
+
+        written = jsn_testing_read_file("./data/data_written.json");
+        ck_assert_str_eq(written, expected);
+        free(written);
+        free(expected);
+    }
+
+    // Strings point into the buffer and can still be changed.
+    char *buffer = jsn_testing_read_file(JSN_TESTING_DATA_FILES_PATHS[1]);
+    size_t length = strlen(buffer);
+    jsn_handle root = jsn_from_buffer_insitu(buffer, length);
+
+    const char *base = jsn_get_value_string(jsn_get(root, 1, "base"));
+    ck_assert_str_eq(base, "USD");
+    ck_assert(base > buffer && base < buffer + length);
+
+    jsn_set_as_string(jsn_get(root, 1, "base"), "EUR");
+    jsn_object_set(root, "extra", jsn_create_string("Heap string."));
+    ck_assert_str_eq(jsn_get_value_string(jsn_get(root, 1, "base")), "EUR");
+    ck_assert_str_eq(jsn_get_value_string(jsn_get(root, 1, "extra")),
+                     "Heap string.");
+    ck_assert_double_eq(
+        jsn_get_value_double(jsn_get(root, 2, "rates", "AED")), 3.67);
+
+    jsn_free(root);
+    free(buffer);
+}
+END_TEST
+
 /* GETTING AND SETTING
  * -------------------------------------------------------------------------*/
 
@@ -96,6 +967,356 @@ START_TEST(jsn_get_test) {
     jsn_free(root);
 }
 
+START_TEST(jsn_path_test) {
+    jsn_handle root = jsn_from_file(JSN_TESTING_DATA_FILES_PATHS[3]);
+
+    // Keys and array indexes.
+    struct jsn_path *kind = jsn_path_compile("kind");
+    struct jsn_path *subreddit =
+        jsn_path_compile("data.children[0].data.subreddit");
+    ck_assert_str_eq(jsn_get_value_string(jsn_path_eval(kind, root)),
+                     "Listing");
+    ck_assert_str_eq(jsn_get_value_string(jsn_path_eval(subreddit, root)),
+                     "science");
+
+    // Misses don't exit.
+    struct jsn_path *missing = jsn_path_compile("data.children[100].data");
+    struct jsn_path *mismatched = jsn_path_compile("data[0]");
+    ck_assert_ptr_null(jsn_path_eval(missing, root));
+    ck_assert_ptr_null(jsn_path_eval(mismatched, root));
+
+    jsn_path_free(kind);
+    jsn_path_free(subreddit);
+    jsn_path_free(missing);
+    jsn_path_free(mismatched);
+    jsn_free(root);
+
+    // Large objects are looked up through their key index, which is built
+    // while parsing so that lookups don't change the tree.
+    root = jsn_from_file(JSN_TESTING_DATA_FILES_PATHS[1]);
+    struct jsn_path *rate = jsn_path_compile("rates.ZWL");
+    struct jsn_path *unknown = jsn_path_compile("rates.XYZ");
+    struct jsn_allocation_stats stats = {0};
+    jsn_count_allocations(&stats);
+    ck_assert_ptr_eq(jsn_path_eval(rate, root),
+                     jsn_get(root, 2, "rates", "ZWL"));
+    ck_assert_ptr_null(jsn_path_eval(unknown, root));
+    jsn_count_allocations(NULL);
+    ck_assert_uint_eq(stats.allocations, 0);
+    jsn_path_free(rate);
+    jsn_path_free(unknown);
+    jsn_free(root);
+
+    // Invalid expressions.
+    ck_assert_ptr_null(jsn_path_compile("a..b"));
+    ck_assert_ptr_null(jsn_path_compile(".a"));
+    ck_assert_ptr_null(jsn_path_compile("a[]"));
+    ck_assert_ptr_null(jsn_path_compile("a[1"));
+    ck_assert_ptr_null(jsn_path_compile("a[1]b"));
+}
+END_TEST
+
+/**
+ * Checks that projected values are the same as the ones of the full tree, in
+ * both parsing modes and with and without an arena.
+ */
+START_TEST(jsn_project_test) {
+    const char *expressions[] = {
+        "kind",
+        "data.children[0].data.subreddit",
+        "data.children[0].data",
+        "data.children[24].data.title",
+        "data.dist",
+        "data.children[100]",
+        "data.unknown.key",
+        "kind.not_an_object",
+    };
+    unsigned int count = sizeof(expressions) / sizeof(expressions[0]);
+
+    struct jsn_path *paths[8];
+    for (unsigned int i = 0; i < count; i++) {
+        paths[i] = jsn_path_compile(expressions[i]);
+    }
+
+    char *buffer = jsn_testing_read_file(JSN_TESTING_DATA_FILES_PATHS[3]);
+    size_t length = strlen(buffer);
+
+    for (int mode = 0; mode < 4; mode++) {
+        jsn_set_option(JSN_OPTION_ARENA, mode & 1);
+        jsn_set_option(JSN_OPTION_STRUCTURAL_INDEX, mode & 2);
+
+        jsn_handle values[8];
+        jsn_handle projected =
+            jsn_project(paths, count, buffer, length, values);
+        jsn_handle tree = jsn_from_buffer(buffer, length);
+
+        for (unsigned int i = 0; i < count; i++) {
+            jsn_handle expected = jsn_path_eval(paths[i], tree);
+
+            if (expected == NULL) {
+                ck_assert_ptr_null(values[i]);
+                continue;
+            }
+
+            char *expected_json = jsn_to_buffer(expected, NULL);
+            char *value_json = jsn_to_buffer(values[i], NULL);
+            ck_assert_str_eq(value_json, expected_json);
+            free(expected_json);
+            free(value_json);
+        }
+
+        jsn_free(projected);
+        jsn_free(tree);
+    }
+
+    jsn_set_option(JSN_OPTION_ARENA, false);
+    jsn_set_option(JSN_OPTION_STRUCTURAL_INDEX, false);
+
+    for (unsigned int i = 0; i < count; i++) {
+        jsn_path_free(paths[i]);
+    }
+    free(buffer);
+
+    // The first of duplicate keys wins, just like with jsn_get.
+    const char *duplicates = "{\"a\": 1, \"a\": 2, \"b\": {\"c\": 3}, "
+                             "\"b\": {\"d\": 4}}";
+    paths[0] = jsn_path_compile("a");
+    paths[1] = jsn_path_compile("b.c");
+    paths[2] = jsn_path_compile("b.d");
+
+    jsn_handle values[3];
+    jsn_handle projected =
+        jsn_project(paths, 3, duplicates, strlen(duplicates), values);
+    ck_assert_int_eq(jsn_get_value_int(values[0]), 1);
+    ck_assert_int_eq(jsn_get_value_int(values[1]), 3);
+    ck_assert_ptr_null(values[2]);
+
+    char *written = jsn_to_buffer(projected, NULL);
+    ck_assert_str_eq(written, "{\"a\":1,\"b\":{\"c\":3}}");
+    free(written);
+    jsn_free(projected);
+
+    for (unsigned int i = 0; i < 3; i++) {
+        jsn_path_free(paths[i]);
+    }
+}
+END_TEST
+
+/**
+ * An allocator that keeps track of the number of live allocations.
+ */
+static void *jsn_testing_malloc(void *user_data, size_t size) {
+    (*(long *)user_data)++;
+    return malloc(size);
+}
+
+static void *jsn_testing_realloc(void *user_data, void *memory, size_t size) {
+    if (memory == NULL) {
+        (*(long *)user_data)++;
+    }
+    return realloc(memory, size);
+}
+
+static void jsn_testing_free(void *user_data, void *memory) {
+    (*(long *)user_data)--;
+    free(memory);
+}
+
+START_TEST(jsn_allocator_test) {
+    long live = 0;
+    struct jsn_allocator allocator = {jsn_testing_malloc, jsn_testing_realloc,
+                                      jsn_testing_free, &live};
+    jsn_set_allocator(&allocator);
+
+    for (int mode = 0; mode < 4; mode++) {
+        jsn_set_option(JSN_OPTION_ARENA, mode & 1);
+        jsn_set_option(JSN_OPTION_STRUCTURAL_INDEX, mode & 2);
+
+        struct jsn_allocation_stats stats = {0};
+        jsn_count_allocations(&stats);
+
+        jsn_handle root = jsn_from_file(JSN_TESTING_DATA_FILES_PATHS[3]);
+        ck_assert_int_gt(live, 0);
+        jsn_object_set(root, "added", jsn_create_string("value"));
+
+        // Buffers handed to the caller don't come from the allocator, the
+        // ones used to write files do.
+        free(jsn_to_buffer(root, NULL));
+        size_t allocations = stats.allocations;
+        jsn_to_file(root, "./data/data_written.json");
+        ck_assert_uint_eq(stats.allocations, allocations + 1);
+        jsn_to_snapshot(root, "./data/data_written.snapshot");
+        ck_assert_uint_gt(stats.allocations, allocations + 1);
+        remove("./data/data_written.snapshot");
+
+        jsn_free(root);
+        jsn_count_allocations(NULL);
+
+        ck_assert_int_eq(live, 0);
+        ck_assert_uint_gt(stats.allocations, 0);
+        ck_assert_uint_eq(stats.allocations, stats.frees);
+        ck_assert_uint_gt(stats.bytes, 0);
+    }
+
+    jsn_set_option(JSN_OPTION_ARENA, false);
+    jsn_set_option(JSN_OPTION_STRUCTURAL_INDEX, false);
+    jsn_set_allocator(NULL);
+
+    // Allocations on worker threads are counted too, a few chunks of records
+    // are parsed at the same time.
+    size_t capacity = 3 << 20;
+    char *buffer = malloc(capacity + 64);
+    size_t length = 0;
+    for (unsigned int i = 0; length < capacity; i++) {
+        length += sprintf(&buffer[length], "{\"id\": %u, \"name\": \"%u\"}\n",
+                          i, i);
+    }
+
+    struct jsn_allocation_stats stats = {0};
+    jsn_count_allocations(&stats);
+
+    size_t count;
+    jsn_handle *records = jsn_ndjson_from_buffer(buffer, length, 4, &count);
+    for (size_t i = 0; i < count; i++) {
+        jsn_free(records[i]);
+    }
+    free(records);
+
+    jsn_count_allocations(NULL);
+    ck_assert_uint_gt(stats.allocations, count);
+    ck_assert_uint_eq(stats.allocations, stats.frees);
+    free(buffer);
+}
+END_TEST
+
+START_TEST(jsn_stats_test) {
+    const char *buffer =
+        "{\"a\": [1, 2.5, \"x\", true, null], \"b\": {\"a\": \"y\"}}";
+    struct jsn_stats stats;
+
+    jsn_reset_stats();
+    jsn_handle root = jsn_from_buffer(buffer, strlen(buffer));
+
+    // Without JSN_STATS nothing is counted.
+    if (!jsn_get_stats(&stats)) {
+        ck_assert_uint_eq(stats.bytes_scanned, 0);
+        jsn_free(root);
+        return;
+    }
+
+    ck_assert_uint_eq(stats.object_tokens, 2);
+    ck_assert_uint_eq(stats.array_tokens, 1);
+    ck_assert_uint_eq(stats.close_tokens, 3);
+    ck_assert_uint_eq(stats.separator_tokens, 8);
+    ck_assert_uint_eq(stats.string_tokens, 5);
+    ck_assert_uint_eq(stats.integer_tokens, 1);
+    ck_assert_uint_eq(stats.double_tokens, 1);
+    ck_assert_uint_eq(stats.boolean_tokens, 1);
+    ck_assert_uint_eq(stats.null_tokens, 1);
+    ck_assert_uint_eq(stats.bytes_scanned, strlen(buffer));
+    ck_assert_uint_eq(stats.strings_copied, 2);
+    ck_assert_uint_eq(stats.keys_copied, 3);
+    ck_assert_uint_eq(stats.max_depth, 2);
+    ck_assert_uint_eq(stats.children_reallocations, 1);
+    jsn_free(root);
+
+    // Appending past the capacity grows the children array.
+    root = jsn_create_array();
+    for (int i = 0; i < 5; i++) {
+        jsn_array_push(root, jsn_create_integer(i));
+    }
+    jsn_free(root);
+
+    jsn_get_stats(&stats);
+    ck_assert_uint_eq(stats.children_reallocations, 3);
+
+    // The two stage mode reads the same tokens.
+    jsn_set_option(JSN_OPTION_STRUCTURAL_INDEX, true);
+    jsn_reset_stats();
+    root = jsn_from_buffer(buffer, strlen(buffer));
+    jsn_set_option(JSN_OPTION_STRUCTURAL_INDEX, false);
+
+    jsn_get_stats(&stats);
+    ck_assert_uint_eq(stats.separator_tokens, 8);
+    ck_assert_uint_eq(stats.string_tokens, 5);
+    ck_assert_uint_eq(stats.max_depth, 2);
+    jsn_free(root);
+}
+END_TEST
+
+START_TEST(jsn_inline_strings_test) {
+    // Keys and strings of every length around the inline capacity, in both
+    // allocation modes.
+    const char *text = "abcdefghijklmnopqrstuvwxyz0123456789";
+    char key[40];
+    char value[40];
+
+    for (int mode = 0; mode < 2; mode++) {
+        jsn_set_option(JSN_OPTION_ARENA, mode == 1);
+        jsn_handle root = jsn_create_object();
+
+        for (int length = 0; length < 32; length++) {
+            snprintf(key, sizeof(key), "%.*s", length + 1, text);
+            snprintf(value, sizeof(value), "%.*s", 31 - length, text);
+
+            // Setting the same key twice replaces the first node.
+            jsn_object_set(root, key, jsn_create_string(text));
+            jsn_handle node =
+                jsn_object_set(root, key, jsn_create_string(value));
+            ck_assert_str_eq(jsn_get_value_string(jsn_get(root, 1, key)),
+                             value);
+
+            // Changing the value keeps the key.
+            jsn_set_as_integer(node, length);
+            jsn_set_as_string(node, text);
+            jsn_set_as_string(node, value);
+            ck_assert_str_eq(jsn_get_value_string(jsn_get(root, 1, key)),
+                             value);
+        }
+
+        // Arrays and objects store their children where the inline key and
+        // string were.
+        jsn_handle node = jsn_get(root, 1, "a");
+        jsn_set_as_object(node);
+        for (int i = 0; i < 20; i++) {
+            snprintf(key, sizeof(key), "%d", i);
+            jsn_object_set(node, key, jsn_create_string(key));
+        }
+        ck_assert_str_eq(jsn_get_value_string(jsn_get(root, 2, "a", "19")),
+                         "19");
+
+        node = jsn_get(root, 1, "ab");
+        jsn_set_as_array(node);
+        jsn_array_push(node, jsn_create_string(text));
+        ck_assert_int_eq(jsn_array_count(jsn_get(root, 1, "ab")), 1);
+
+        char *json = jsn_to_buffer(root, NULL);
+        jsn_free(root);
+
+        // The parsed document reads back the same, also through the binary
+        // encoding, which refers back to repeated keys.
+        jsn_handle parsed = jsn_from_buffer(json, strlen(json));
+        size_t binary_length;
+        char *binary = jsn_to_binary(parsed, &binary_length);
+        jsn_handle decoded = jsn_from_binary(binary, binary_length);
+
+        char *parsed_json = jsn_to_buffer(parsed, NULL);
+        char *decoded_json = jsn_to_buffer(decoded, NULL);
+        ck_assert_str_eq(parsed_json, json);
+        ck_assert_str_eq(decoded_json, json);
+
+        free(json);
+        free(binary);
+        free(parsed_json);
+        free(decoded_json);
+        jsn_free(parsed);
+        jsn_free(decoded);
+    }
+
+    jsn_set_option(JSN_OPTION_ARENA, false);
+}
+END_TEST
+
 START_TEST(jsn_get_unknown_key_test) {
     jsn_handle root = jsn_from_file(JSN_TESTING_DATA_FILES_PATHS[0]);
 
@@ -184,6 +1405,151 @@ START_TEST(jsn_array_push_and_get_item_test) {
     ck_assert_int_eq(jsn_get_value_int(jsn_get_array_item(array_retrieved, 4)), 5);
 }
 
+START_TEST(jsn_array_push_many_test) {
+    jsn_handle array = jsn_create_array();
+
+    // Push enough items to grow the children storage many times over.
+    for (unsigned int i = 0; i < 10000; i++) {
+        jsn_array_push(array, jsn_create_integer(i));
+    }
+
+    ck_assert_int_eq(jsn_array_count(array), 10000);
+    for (unsigned int i = 0; i < 10000; i++) {
+        ck_assert_int_eq(jsn_get_value_int(jsn_get_array_item(array, i)), i);
+    }
+
+    // Mutating the array should reset it's children.
+    jsn_set_as_array(array);
+    ck_assert_int_eq(jsn_array_count(array), 0);
+    jsn_array_push(array, jsn_create_integer(1));
+    ck_assert_int_eq(jsn_get_value_int(jsn_get_array_item(array, 0)), 1);
+
+    jsn_free(array);
+}
+END_TEST
+
+START_TEST(jsn_object_set_many_test) {
+    jsn_handle object = jsn_create_object();
+    char key[32];
+
+    // Large objects look up their keys through a hash index.
+    for (int i = 0; i < 5000; i++) {
+        sprintf(key, "key_%d", i);
+        jsn_object_set(object, key, jsn_create_integer(i));
+    }
+
+    // Setting an existing key replaces it's value in place.
+    for (int i = 0; i < 5000; i += 2) {
+        sprintf(key, "key_%d", i);
+        jsn_object_set(object, key, jsn_create_integer(-i));
+    }
+
+    for (int i = 0; i < 5000; i++) {
+        sprintf(key, "key_%d", i);
+        int expected = i % 2 == 0 ? -i : i;
+        ck_assert_int_eq(jsn_get_value_int(jsn_get(object, 1, key)), expected);
+    }
+
+    // Mutating the object drops it's children and their index.
+    jsn_set_as_object(object);
+    for (int i = 0; i < 100; i++) {
+        sprintf(key, "other_%d", i);
+        jsn_object_set(object, key, jsn_create_integer(i));
+    }
+    ck_assert_int_eq(jsn_get_value_int(jsn_get(object, 1, "other_99")), 99);
+    ck_assert_int_eq(jsn_get_value_int(jsn_get(object, 1, "other_0")), 0);
+
+    jsn_free(object);
+}
+END_TEST
+
+/* ARENA MODE
+ * --------------------------------------------------------------------------*/
+
+START_TEST(jsn_arena_from_file_test) {
+    jsn_set_option(JSN_OPTION_ARENA, true);
+
+    // Parsed documents can be read and mutated.
+    jsn_handle root = jsn_from_file(JSN_TESTING_DATA_FILES_PATHS[1]);
+    jsn_handle rates = jsn_get(root, 1, "rates");
+    ck_assert_double_eq(jsn_get_value_double(jsn_get(rates, 1, "AED")), 3.67);
+
+    jsn_set_as_string(jsn_get(rates, 1, "USD"), "One dollar.");
+    ck_assert_str_eq(jsn_get_value_string(jsn_get(rates, 1, "USD")),
+                     "One dollar.");
+
+    jsn_set_as_integer(jsn_get(root, 1, "base"), 10);
+    ck_assert_int_eq(jsn_get_value_int(jsn_get(root, 1, "base")), 10);
+
+    // Heap nodes can be mixed into an arena document.
+    jsn_set_option(JSN_OPTION_ARENA, false);
+    jsn_handle heap_object = jsn_create_object();
+    jsn_object_set(heap_object, "name", jsn_create_string("Heap string."));
+    jsn_set_option(JSN_OPTION_ARENA, true);
+
+    jsn_object_set(root, "heap-object", heap_object);
+    jsn_object_set(rates, "AED", jsn_create_double(3.68));
+    ck_assert_double_eq(jsn_get_value_double(jsn_get(rates, 1, "AED")), 3.68);
+    ck_assert_str_eq(
+        jsn_get_value_string(jsn_get(root, 2, "heap-object", "name")),
+        "Heap string.");
+
+    jsn_free(root);
+    jsn_set_option(JSN_OPTION_ARENA, false);
+}
+END_TEST
+
+START_TEST(jsn_arena_create_test) {
+    jsn_set_option(JSN_OPTION_ARENA, true);
+
+    // The node that isn't added to any other becomes the document's root.
+    jsn_handle root = jsn_create_object();
+    jsn_handle array = jsn_object_set(root, "numbers", jsn_create_array());
+    for (unsigned int i = 0; i < 1000; i++) {
+        jsn_array_push(array, jsn_create_integer(i));
+    }
+
+    jsn_object_set(root, "name", jsn_create_string("Arena"));
+    jsn_object_set(root, "name", jsn_create_string("Arena document"));
+
+    ck_assert_int_eq(jsn_array_count(jsn_get(root, 1, "numbers")), 1000);
+    ck_assert_int_eq(jsn_get_value_int(jsn_get_array_item(array, 999)), 999);
+    ck_assert_str_eq(jsn_get_value_string(jsn_get(root, 1, "name")),
+                     "Arena document");
+
+    jsn_set_as_array(array);
+    ck_assert_int_eq(jsn_array_count(array), 0);
+
+    jsn_free(root);
+    jsn_set_option(JSN_OPTION_ARENA, false);
+}
+END_TEST
+
+START_TEST(jsn_arena_bottom_up_test) {
+    struct jsn_allocation_stats stats = {0};
+    jsn_count_allocations(&stats);
+    jsn_set_option(JSN_OPTION_ARENA, true);
+
+    // The root is created last, and the first node ends up deepest.
+    jsn_handle a = jsn_create_integer(1);
+    jsn_handle b = jsn_create_array();
+    jsn_handle c = jsn_create_array();
+    jsn_array_push(c, b);
+    jsn_array_push(b, a);
+    jsn_free(c);
+    ck_assert_uint_eq(stats.allocations, stats.frees);
+
+    // The next document gets an arena of it's own.
+    jsn_handle root = jsn_create_array();
+    jsn_array_push(root, jsn_create_integer(2));
+    jsn_free(root);
+
+    jsn_set_option(JSN_OPTION_ARENA, false);
+    jsn_count_allocations(NULL);
+    ck_assert_uint_eq(stats.allocations, stats.frees);
+}
+END_TEST
+
 /* INTERNAL TESTS:
  * --------------------------------------------------------------------------*/
 
@@ -196,16 +1562,53 @@ Suite *sample_suite(void) {
     tc_core = tcase_create("Parsing");
     tcase_add_test(tc_core, jsn_from_file_test);
     tcase_add_test(tc_core, jsn_to_file_test);
+    tcase_add_test(tc_core, jsn_to_buffer_test);
+    tcase_add_test(tc_core, jsn_number_round_trip_test);
+    tcase_add_test(tc_core, jsn_string_scanning_test);
+    tcase_add_test(tc_core, jsn_number_parsing_test);
+    tcase_add_test(tc_core, jsn_structural_index_test);
+    tcase_add_test(tc_core, jsn_structural_index_escapes_test);
+    tcase_add_test(tc_core, jsn_key_interning_test);
+    tcase_add_test(tc_core, jsn_from_buffer_test);
+    tcase_add_test(tc_core, jsn_from_buffer_insitu_test);
+    tcase_add_test(tc_core, jsn_parser_feed_test);
+    tcase_add_test(tc_core, jsn_events_test);
+    tcase_add_test(tc_core, jsn_cursor_test);
+    tcase_add_test(tc_core, jsn_binary_test);
+    tcase_add_test(tc_core, jsn_snapshot_test);
+    tcase_add_test(tc_core, jsn_tape_test);
+    tcase_add_test(tc_core, jsn_ndjson_test);
+    tcase_add_test(tc_core, jsn_parallel_test);
 
     // Getters and setters
     tcase_add_test(tc_core, jsn_get_test);
+    tcase_add_test(tc_core, jsn_path_test);
+    tcase_add_test(tc_core, jsn_project_test);
+    tcase_add_test(tc_core, jsn_allocator_test);
+    tcase_add_test(tc_core, jsn_stats_test);
+    tcase_add_test(tc_core, jsn_inline_strings_test);
     tcase_add_test(tc_core, jsn_object_set_test);
     tcase_add_test(tc_core, jsn_array_push_and_get_item_test);
+    tcase_add_test(tc_core, jsn_array_push_many_test);
+    tcase_add_test(tc_core, jsn_object_set_many_test);
+
+    // Arena mode
+    tcase_add_test(tc_core, jsn_arena_from_file_test);
+    tcase_add_test(tc_core, jsn_arena_create_test);
+    tcase_add_test(tc_core, jsn_arena_bottom_up_test);
 
     // Exist tests
     tcase_add_exit_test(tc_core, jsn_get_unknown_key_test, 1);
     tcase_add_exit_test(tc_core, jsn_from_file_unknown_file_test, 1);
     tcase_add_exit_test(tc_core, jsn_from_file_bad_file_test, 1);
+    tcase_add_exit_test(tc_core, jsn_structural_index_bad_file_test, 1);
+    tcase_add_exit_test(tc_core, jsn_from_buffer_truncated_test, 1);
+    tcase_add_exit_test(tc_core, jsn_parser_incomplete_test, 1);
+    tcase_add_exit_test(tc_core, jsn_cursor_unknown_key_test, 1);
+    tcase_add_exit_test(tc_core, jsn_binary_truncated_test, 1);
+    tcase_add_exit_test(tc_core, jsn_snapshot_unknown_key_test, 1);
+    tcase_add_exit_test(tc_core, jsn_snapshot_truncated_test, 1);
+    tcase_add_exit_test(tc_core, jsn_tape_unknown_key_test, 1);
 
     suite_add_tcase(s, tc_core);
 